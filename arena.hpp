@@ -0,0 +1,93 @@
+/**
+ * ______________________________________________________
+ * Per-instance memory arenas for wrapped containers.
+ * 
+ * @file 	arena.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+
+namespace mkg {
+
+    /**
+     * A `std::pmr::memory_resource` meant to be owned by a single `concurrent` resource (or shard), so
+     * that nodes allocated by the wrapped container inside the exclusive section come from a private pool
+     * instead of the global heap, and do not contend with allocations of unrelated threads.
+     * 
+     * Allocations of the wrapped container are serialized by the exclusive lock already, so the pool 
+     * itself is unsynchronized; a spin lock, which is uncontended while the arena is only used under 
+     * the exclusive lock, keeps it safe otherwise (eg. elements moved out by `take()` are freed later).
+     * Memory is obtained from the upstream resource in chunks; with a first-touch NUMA policy, chunks 
+     * end up on the node of the writer thread which touched them first. A NUMA aware upstream 
+     * resource can be passed to the pool's constructor as usual.
+     * 
+     * ~~~cpp
+     * mkg::arena routes_arena;
+     * mkg::concurrent<std::pmr::map<std::pmr::string, std::pmr::string>> routes{ std::allocator_arg, &routes_arena };
+     * ~~~
+     * 
+     * @tparam PoolResource Type of the underlying (unsynchronized) memory resource
+     */
+    template<std::derived_from<std::pmr::memory_resource> PoolResource = std::pmr::unsynchronized_pool_resource>
+    class basic_arena : public std::pmr::memory_resource, private noncopyable {
+    public:
+        /**
+         * @brief Construct the pool with `args` (eg. `std::pmr::pool_options`, or an upstream resource).
+         */
+        template<typename... Args>
+        requires std::constructible_from<PoolResource, Args&&...>
+        explicit basic_arena(Args && ... args) : pool(std::forward<Args>(args)...) {}
+
+        /**
+         * @brief Return all memory of the arena to the upstream resource, even if it is still in use.
+         */
+        void release() {
+            std::lock_guard<spin_shared_mutex<>> guard{ mutex };
+            pool.release();
+        }
+
+    protected:
+        void * do_allocate(std::size_t bytes, std::size_t alignment) override {
+            std::lock_guard<spin_shared_mutex<>> guard{ mutex };
+            return pool.allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void * pointer, std::size_t bytes, std::size_t alignment) override {
+            std::lock_guard<spin_shared_mutex<>> guard{ mutex };
+            pool.deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        spin_shared_mutex<> mutex;
+        PoolResource pool;
+    };
+
+    /**
+     * An arena which recycles freed blocks, in size-segregated pools.
+     */
+    using arena = basic_arena<std::pmr::unsynchronized_pool_resource>;
+
+    /**
+     * An arena which never frees memory until it is destroyed (or released); the cheapest option for 
+     * containers which are mostly filled once.
+     */
+    using monotonic_arena = basic_arena<std::pmr::monotonic_buffer_resource>;
+}
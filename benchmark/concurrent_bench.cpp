@@ -0,0 +1,370 @@
+/**
+ * ______________________________________________________
+ * Benchmarks for the concurrent wrapper and its lock backends.
+ * 
+ * Run with --benchmark_filter=<regex> to select a subset, eg.
+ * --benchmark_filter='mixed/std::shared_mutex/payload:256/writes:5'
+ * 
+ * @file 	concurrent_bench.cpp
+ * @author 	Mustafa Kemal GILOR <mustafagilor@gmail.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <array>        // std::array
+#include <cstdint>      // std::uint64_t
+#include <string>       // std::string
+#include <map>          // std::map
+#include <deque>        // std::deque
+#include <optional>     // std::optional
+
+#include "concurrent_stl.hpp"
+#include "concurrent_queue.hpp"
+#include "buffered_writer.hpp"
+#include "arena.hpp"
+#include "lockable_spin.hpp"
+#include "lockable_distributed.hpp"
+#include "lockable_combining.hpp"
+#include "lockable_elision.hpp"
+#include "lockable_compact.hpp"
+#include "lockable_fair.hpp"
+#include "lockable_cohort.hpp"
+#include "lockable_mcs.hpp"
+#include "lockable_reentrant.hpp"
+
+#if defined(CONCURRENT_BENCH_WITH_BOOST)
+#include <boost/thread/shared_mutex.hpp>
+#endif
+
+using namespace mkg;
+
+namespace {
+
+    constexpr std::size_t max_threads = 64;
+
+    /**
+     * Resource of `Size` bytes, wrapped by the general purpose `concurrent` (the seqlock backend opts in
+     * via `seqlocked<payload>`).
+     */
+    template<std::size_t Size>
+    struct payload {
+        std::array<std::uint8_t, Size> data = {};
+    };
+
+    /**
+     * Cheap per-thread pseudo random number generator (xorshift64).
+     */
+    struct xorshift {
+        std::uint64_t state;
+        std::uint64_t operator()() noexcept {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    /**
+     * Every thread repeatedly writes its own element of an array of `concurrent` objects. 
+     * Without padding, neighbouring elements (and their locks) share cache lines.
+     */
+    template<typename LockableType>
+    void false_sharing(benchmark::State & state) {
+        using slot_t = concurrent<payload<8>, LockableType>;
+        // The lock must be part of every slot, otherwise there is nothing to align.
+        static_assert(sizeof(slot_t) >= sizeof(payload<8>) + sizeof(LockableType));
+        static std::array<slot_t, max_threads> slots;
+        auto & slot = slots[static_cast<std::size_t>(state.thread_index()) % max_threads];
+        for (auto _ : state) {
+            auto write_accessor = slot.write_access_handle();
+            benchmark::DoNotOptimize(++(*write_accessor).data.front());
+        }
+        state.counters["object_size"] = benchmark::Counter(sizeof(slot), benchmark::Counter::kAvgThreads);
+    }
+
+    /**
+     * All threads share a single resource; each iteration either reads (touching the first and last byte)
+     * or writes it. `state.range(0)` is the percentage of writes.
+     */
+    template<typename ConcurrentType>
+    void mixed(benchmark::State & state) {
+        static ConcurrentType resource;
+        const auto write_percentage = static_cast<std::uint64_t>(state.range(0));
+        xorshift random{ 0x9E3779B97F4A7C15ull * (static_cast<std::uint64_t>(state.thread_index()) + 1) };
+        std::uint64_t reads = 0, writes = 0;
+        for (auto _ : state) {
+            if (random() % 100 < write_percentage) {
+                auto write_accessor = resource.write_access_handle();
+                (*write_accessor).data.front()++;
+                benchmark::DoNotOptimize((*write_accessor).data.back()++);
+                ++writes;
+            } else {
+                auto read_accessor = resource.read_access_handle();
+                benchmark::DoNotOptimize((*read_accessor).data.front());
+                benchmark::DoNotOptimize((*read_accessor).data.back());
+                ++reads;
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["reads"] = benchmark::Counter(static_cast<double>(reads), benchmark::Counter::kIsRate);
+        state.counters["writes"] = benchmark::Counter(static_cast<double>(writes), benchmark::Counter::kIsRate);
+    }
+
+    /**
+     * Counterpart of `mixed`, where readers go through a per-thread `read_cache` of the resource.
+     */
+    template<typename ConcurrentType>
+    void cached_mixed(benchmark::State & state) {
+        static ConcurrentType resource;
+        thread_local read_cache cache{ resource };
+        const auto write_percentage = static_cast<std::uint64_t>(state.range(0));
+        xorshift random{ 0x9E3779B97F4A7C15ull * (static_cast<std::uint64_t>(state.thread_index()) + 1) };
+        for (auto _ : state) {
+            if (random() % 100 < write_percentage) {
+                auto write_accessor = resource.write_access_handle();
+                (*write_accessor).data.front()++;
+                benchmark::DoNotOptimize((*write_accessor).data.back()++);
+            } else {
+                const auto & snapshot = cache.cached_read();
+                benchmark::DoNotOptimize(snapshot.data.front());
+                benchmark::DoNotOptimize(snapshot.data.back());
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * Every iteration reads the resource through an outer accessor and 4 helpers which take their own
+     * `read_access_handle()`. With `Nested`, the helpers run while the outer accessor is alive (which requires
+     * a `reentrant` lock); otherwise they run after it, each acquiring the lock again.
+     */
+    template<typename ConcurrentType, bool Nested>
+    void nested_reads(benchmark::State & state) {
+        static ConcurrentType resource;
+        const auto helper = [] {
+            auto read_accessor = resource.read_access_handle();
+            benchmark::DoNotOptimize((*read_accessor).data.front());
+        };
+        for (auto _ : state) {
+            {
+                auto read_accessor = resource.read_access_handle();
+                benchmark::DoNotOptimize((*read_accessor).data.back());
+                if constexpr (Nested) {
+                    helper(); helper(); helper(); helper();
+                }
+            }
+            if constexpr (!Nested) {
+                helper(); helper(); helper(); helper();
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * All threads insert into (and update) a single shared map, which is the write path of the 
+     * producers in `main.cpp`. `UseFunctionalWrite` selects `write(fn)` instead of `write_access_handle()`.
+     */
+    template<typename ConcurrentType, bool UseFunctionalWrite>
+    void write_contention(benchmark::State & state) {
+        static ConcurrentType resource;
+        xorshift random{ 0x9E3779B97F4A7C15ull * (static_cast<std::uint64_t>(state.thread_index()) + 1) };
+        for (auto _ : state) {
+            const auto key = random() % 4096;
+            if constexpr (UseFunctionalWrite) {
+                resource.write([key](auto & map) { ++map[key]; });
+            } else {
+                auto write_accessor = resource.write_access_handle();
+                ++(*write_accessor)[key];
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * All threads insert into and erase from a single shared map, so that every write allocates or frees a node
+     * inside the exclusive section.
+     */
+    template<typename ConcurrentType>
+    void map_churn(benchmark::State & state) {
+        static ConcurrentType resource;
+        xorshift random{ 0x9E3779B97F4A7C15ull * (static_cast<std::uint64_t>(state.thread_index()) + 1) };
+        for (auto _ : state) {
+            const auto key = random() % 4096;
+            auto write_accessor = resource.write_access_handle();
+            if (write_accessor->erase(key) == 0) {
+                write_accessor->emplace(key, key);
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * Deferred counterpart of `write_contention`; increments are buffered per thread and applied in batches.
+     */
+    template<typename ConcurrentType>
+    void buffered_write_contention(benchmark::State & state) {
+        struct increment {
+            std::uint64_t key;
+            void operator()(typename ConcurrentType::value_type & map) const { ++map[key]; }
+        };
+        static ConcurrentType resource;
+        static buffered_writer<ConcurrentType, increment> writer{ resource };
+        xorshift random{ 0x9E3779B97F4A7C15ull * (static_cast<std::uint64_t>(state.thread_index()) + 1) };
+        for (auto _ : state) {
+            writer.write(increment{ random() % 4096 });
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * Baseline queue; a `std::deque` guarded by `concurrent`, as queues were built before `concurrent_queue`.
+     */
+    struct locked_deque {
+        bool try_push(std::uint64_t value) {
+            queue.write_access_handle()->push_back(value);
+            return true;
+        }
+
+        std::optional<std::uint64_t> try_pop() {
+            auto write_accessor = queue.write_access_handle();
+            if (write_accessor->empty()) {
+                return std::nullopt;
+            }
+            const auto value = write_accessor->front();
+            write_accessor->pop_front();
+            return value;
+        }
+
+        concurrent<std::deque<std::uint64_t>, std::shared_mutex> queue;
+    };
+
+    struct bounded_queue : bounded_concurrent_queue<std::uint64_t> {
+        bounded_queue() : bounded_concurrent_queue{ 1024 } {}
+    };
+
+    /**
+     * All threads share a single queue; each iteration pushes an element, then pops one.
+     */
+    template<typename QueueType>
+    void queue_pairs(benchmark::State & state) {
+        static QueueType queue;
+        std::uint64_t value = static_cast<std::uint64_t>(state.thread_index());
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(queue.try_push(value++));
+            benchmark::DoNotOptimize(queue.try_pop());
+        }
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+
+    template<typename ConcurrentType>
+    void register_mixed(const std::string & backend, std::size_t payload_size) {
+        const auto name = "mixed/" + backend + "/payload:" + std::to_string(payload_size);
+        benchmark::RegisterBenchmark(name.c_str(), mixed<ConcurrentType>)
+            ->ArgName("writes")->Arg(0)->Arg(5)->Arg(50)->ThreadRange(1, max_threads)->UseRealTime();
+    }
+
+    /**
+     * Registers the reader:writer mix benchmarks of a backend, for every payload size.
+     * 
+     * @tparam Concurrent A `concurrent` like template, parameterized by the resource type only
+     */
+    template<template <typename> typename Concurrent>
+    void register_backend(const std::string & backend) {
+        register_mixed<Concurrent<payload<16>>>(backend, 16);
+        register_mixed<Concurrent<payload<256>>>(backend, 256);
+        register_mixed<Concurrent<payload<4096>>>(backend, 4096);
+    }
+
+    template<typename T> using stl_backend = concurrent<T, std::shared_mutex>;
+    template<typename T> using stl_cache_aligned_backend = concurrent<T, cache_aligned<std::shared_mutex>>;
+    template<typename T> using stl_instrumented_backend = concurrent<T, instrumented<std::shared_mutex>>;
+    template<typename T> using spin_backend = concurrent<T, spin_shared_mutex<writer_preference>>;
+    template<typename T> using spin_reader_preference_backend = concurrent<T, spin_shared_mutex<reader_preference>>;
+    template<typename T> using distributed_backend = concurrent<T, distributed_shared_mutex<>>;
+    using map_t = std::map<std::uint64_t, std::uint64_t>;
+    using pmr_map_t = std::pmr::map<std::uint64_t, std::uint64_t>;
+
+    /**
+     * A shared map whose nodes are allocated from its own arena.
+     */
+    struct arena_map : concurrent<pmr_map_t, std::shared_mutex> {
+        static mkg::arena & map_arena() {
+            static mkg::arena instance;
+            return instance;
+        }
+        arena_map() : concurrent{ std::allocator_arg, static_cast<std::pmr::memory_resource *>(&map_arena()) } {}
+    };
+    template<typename T> using elided_backend = concurrent<T, elided<std::shared_mutex>>;
+    template<typename T> using compact_backend = concurrent<T, compact_shared_mutex>;
+    template<typename T> using phase_fair_backend = fair_concurrent<T, fairness::phase_fair>;
+    template<typename T> using ticket_backend = fair_concurrent<T, fairness::fifo>;
+    template<typename T> using cohort_backend = concurrent<T, cohort_shared_mutex<>>;
+    template<typename T> using mcs_backend = concurrent<T, mcs_shared_mutex>;
+    template<typename T> using seqlock_backend = concurrent<seqlocked<T>>;
+    template<typename T> using rcu_backend = concurrent<rcu<T>>;
+#if defined(CONCURRENT_BENCH_WITH_BOOST)
+    template<typename T> using boost_backend = concurrent<T, boost::shared_mutex, boost::shared_lock, boost::unique_lock>;
+#endif
+}
+
+BENCHMARK_TEMPLATE(false_sharing, std::shared_mutex)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(false_sharing, cache_aligned<std::shared_mutex>)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(write_contention, concurrent<map_t, std::shared_mutex>, false)
+    ->Name("write_contention/write_access_handle/std::shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(write_contention, concurrent<map_t, flat_combining<std::shared_mutex>>, true)
+    ->Name("write_contention/write/flat_combining<std::shared_mutex>")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(write_contention, concurrent<map_t, cohort_shared_mutex<>>, false)
+    ->Name("write_contention/write_access_handle/cohort_shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(write_contention, concurrent<map_t, mcs_shared_mutex>, false)
+    ->Name("write_contention/write_access_handle/mcs_shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(buffered_write_contention, concurrent<map_t, std::shared_mutex>)
+    ->Name("write_contention/buffered_writer/std::shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(map_churn, concurrent<map_t, std::shared_mutex>)
+    ->Name("map_churn/std::map/std::shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(map_churn, arena_map)
+    ->Name("map_churn/std::pmr::map+arena/std::shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(cached_mixed, concurrent<payload<256>, versioned<std::shared_mutex>>)
+    ->Name("mixed/read_cache<versioned<std::shared_mutex>>/payload:256")
+    ->ArgName("writes")->Arg(0)->Arg(5)->Arg(50)->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(nested_reads, concurrent<payload<256>, std::shared_mutex>, false)
+    ->Name("nested_reads/relock/std::shared_mutex")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(nested_reads, concurrent<payload<256>, reentrant<std::shared_mutex>>, true)
+    ->Name("nested_reads/nested/reentrant<std::shared_mutex>")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_pairs, locked_deque)
+    ->Name("queue_pairs/concurrent<std::deque>")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_pairs, concurrent_queue<std::uint64_t>)
+    ->Name("queue_pairs/concurrent_queue")->ThreadRange(1, max_threads)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_pairs, bounded_queue)
+    ->Name("queue_pairs/bounded_concurrent_queue")->ThreadRange(1, max_threads)->UseRealTime();
+
+int main(int argc, char ** argv) {
+    register_backend<stl_backend>("std::shared_mutex");
+    register_backend<stl_cache_aligned_backend>("cache_aligned<std::shared_mutex>");
+    register_backend<stl_instrumented_backend>("instrumented<std::shared_mutex>");
+#if defined(CONCURRENT_BENCH_WITH_BOOST)
+    register_backend<boost_backend>("boost::shared_mutex");
+#endif
+    register_backend<spin_backend>("spin_shared_mutex<writer_preference>");
+    register_backend<spin_reader_preference_backend>("spin_shared_mutex<reader_preference>");
+    register_backend<distributed_backend>("distributed_shared_mutex");
+    register_backend<elided_backend>("elided<std::shared_mutex>");
+    register_backend<compact_backend>("compact_shared_mutex");
+    register_backend<phase_fair_backend>("phase_fair_shared_mutex");
+    register_backend<ticket_backend>("ticket_shared_mutex");
+    register_backend<cohort_backend>("cohort_shared_mutex");
+    register_backend<mcs_backend>("mcs_shared_mutex");
+    register_backend<seqlock_backend>("seqlock");
+    register_backend<rcu_backend>("rcu");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
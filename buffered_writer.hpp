@@ -0,0 +1,162 @@
+/**
+ * ______________________________________________________
+ * Deferred (batched) writes to a concurrent resource.
+ *
+ * @file 	buffered_writer.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mkg {
+
+    /**
+     * A write buffer in front of a `concurrent` resource. Instead of taking the exclusive lock for every
+     * write, operations are appended to the calling thread's buffer, and a buffer is applied through a single
+     * `write_access_handle()` once it holds `max_pending` operations, or its oldest operation is older than
+     * `max_delay`. Reading through the writer applies every buffer first, so reads observe all writes made
+     * before them.
+     *
+     * Buffers are striped by thread (see `detail::this_thread_index()`); operations of a thread are applied in
+     * the order they were written, operations of different threads in no particular order. The delay is only
+     * checked when writing (every `delay_check_interval` writes), so a writer which becomes idle should be `flush()`ed.
+     *
+     * @note Do not write through the buffered writer while holding an accessor of the resource; a flush
+     * would deadlock on it.
+     *
+     * @tparam ConcurrentType A `concurrent` type
+     * @tparam Operation      A callable invoked with `value_type &`, eg. a lambda or a small struct describing the update
+     * @tparam StripeCount    Amount of buffers
+     */
+    template<typename ConcurrentType,
+        typename Operation = std::function<void(typename ConcurrentType::value_type &)>,
+        std::size_t StripeCount = 32>
+    requires std::invocable<Operation &, typename ConcurrentType::value_type &> && (StripeCount > 0)
+    class buffered_writer : private noncopyable {
+    public:
+        using value_type = typename ConcurrentType::value_type;
+        using clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Reading the clock costs about as much as an uncontended lock, so a buffer only checks
+         * its delay every this many writes.
+         */
+        static constexpr std::size_t delay_check_interval = 8;
+
+        /**
+         * @brief Create a buffer in front of `resource`, which must outlive the writer.
+         *
+         * @param max_pending   A buffer is applied when it holds this many operations
+         * @param max_delay     A buffer is applied when its oldest operation is older than this
+         */
+        explicit buffered_writer(ConcurrentType & resource, std::size_t max_pending = 64,
+            clock::duration max_delay = std::chrono::milliseconds{ 1 }) :
+            resource{ resource }, max_pending{ std::max<std::size_t>(max_pending, 1) }, max_delay{ max_delay } {}
+
+        /**
+         * @brief Apply all pending operations.
+         */
+        ~buffered_writer() {
+            flush();
+        }
+
+        /**
+         * @brief Buffer an operation; applies the calling thread's buffer if it has reached a threshold.
+         */
+        template<typename Fn>
+        requires std::constructible_from<Operation, Fn&&>
+        void write(Fn && fn) {
+            auto & local = stripes[detail::this_thread_index() % StripeCount];
+            std::lock_guard<std::mutex> guard{ local.mutex };
+            if(local.pending.empty()) {
+                local.oldest = clock::now();
+            }
+            local.pending.emplace_back(std::forward<Fn>(fn));
+            const auto size = local.pending.size();
+            if(size >= max_pending || (size % delay_check_interval == 0 && clock::now() - local.oldest >= max_delay)) {
+                auto accessor = resource.write_access_handle();
+                apply(*accessor, local.pending);
+            }
+        }
+
+        /**
+         * @brief Apply the pending operations of every buffer, within a single exclusive section.
+         */
+        void flush() {
+            // Buffers are always locked in ascending order, before the resource.
+            std::array<std::unique_lock<std::mutex>, StripeCount> guards;
+            bool empty = true;
+            for(std::size_t i = 0; i < StripeCount; ++i) {
+                guards[i] = std::unique_lock<std::mutex>{ stripes[i].mutex };
+                empty = empty && stripes[i].pending.empty();
+            }
+            if(empty) {
+                return;
+            }
+            auto accessor = resource.write_access_handle();
+            for(auto & stripe : stripes) {
+                apply(*accessor, stripe.pending);
+            }
+        }
+
+        /**
+         * @brief Apply all pending operations, then get read-only (shared) access to the resource.
+         */
+        decltype(auto) read_access_handle() {
+            flush();
+            return std::as_const(resource).read_access_handle();
+        }
+
+        /**
+         * @brief Apply all pending operations, then invoke `fn` with the resource while it is locked shared.
+         */
+        template<typename Fn>
+        decltype(auto) read(Fn && fn) {
+            flush();
+            return std::as_const(resource).read(std::forward<Fn>(fn));
+        }
+
+    private:
+        struct alignas(cache_line_size) stripe {
+            std::mutex mutex;
+            std::vector<Operation> pending;
+            clock::time_point oldest;
+        };
+
+        /**
+         * @brief Invoke every operation of `pending`, then discard them; if one throws, the rest are discarded
+         * as well. Keeps the capacity of `pending` for the next batch.
+         */
+        static void apply(value_type & value, std::vector<Operation> & pending) {
+            try {
+                for(auto & operation : pending) {
+                    std::invoke(operation, value);
+                }
+            } catch(...) {
+                pending.clear();
+                throw;
+            }
+            pending.clear();
+        }
+
+        ConcurrentType & resource;
+        const std::size_t max_pending;
+        const clock::duration max_delay;
+        std::array<stripe, StripeCount> stripes;
+    };
+}
@@ -15,9 +15,52 @@
 #include <memory>
 #include <chrono>
 #include <type_traits>
+#include <array>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <optional>
+#include <variant>
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <concepts>
+#include <coroutine>
+#include <span>
+#include <ranges>
+#include <cassert>
+#include <source_location>
+#include <limits>
 
 namespace mkg {
 
+    /**
+     * Size of a destructive interference (false-sharing) region, in bytes.
+     * 
+     * Objects which are modified independently by different threads should be
+     * placed at least this far apart from each other.
+     */
+#if defined(__cpp_lib_hardware_interference_size)
+#  if defined(__GNUC__) && !defined(__clang__)
+    // GCC warns that the value depends on -mtune; we accept that, as it only affects padding.
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Winterference-size"
+#  endif
+    inline constexpr std::size_t cache_line_size = std::hardware_destructive_interference_size;
+#  if defined(__GNUC__) && !defined(__clang__)
+#    pragma GCC diagnostic pop
+#  endif
+#else
+    inline constexpr std::size_t cache_line_size = 64;
+#endif
+
     /**
      * Checks whether given type T satisfies the requirements of
      * `BasicLockable` concept (a.k.a named requirement).
@@ -157,6 +200,54 @@ namespace mkg {
 
     };
 
+    /**
+     * Checks whether given type T satisfies the requirements of
+     * `upgradeable_lockable` concept (a.k.a named requirement).
+     * 
+     * An upgrade lock is a shared lock which can be atomically converted into an exclusive lock 
+     * (and back). Only one thread may hold the upgrade lock at a time, while other threads may hold 
+     * shared locks.
+     * 
+     * ** There are no official named requirements for this **, the operations follow boost::upgrade_mutex.
+     * 
+     * @tparam T Type to check
+     */
+    template<typename T>
+    concept upgradeable_lockable = basic_shared_lockable<T> && requires (T a) {
+
+        /**
+         * @brief Instantiation of type T must have public functions named `lock_upgrade` and `unlock_upgrade`
+         * and they must have return type of `void`.
+         */
+        { a.lock_upgrade() } -> std::same_as<void>;
+        { a.unlock_upgrade() } -> std::same_as<void>;
+
+        /**
+         * @brief Instantiation of type T must have a public function named `unlock_upgrade_and_lock`, which
+         * atomically converts the upgrade lock into an exclusive lock, and it must have return type of `void`.
+         */
+        { a.unlock_upgrade_and_lock() } -> std::same_as<void>;
+
+        /**
+         * @brief Instantiation of type T must have a public function named `unlock_and_lock_upgrade`, which
+         * atomically converts an exclusive lock into an upgrade lock, and it must have return type of `void`.
+         */
+        { a.unlock_and_lock_upgrade() } -> std::same_as<void>;
+    };
+
+    /**
+     * Customization point which describes how a `LockType` adopts a `Lockable` already locked by the caller.
+     * 
+     * Defaults to `std::adopt_lock`; specialize it for lock types which expect a different tag 
+     * (eg. boost::unique_lock).
+     * 
+     * @tparam LockType RAII lock type (eg. std::unique_lock)
+     */
+    template<template <typename...> typename LockType>
+    struct lock_traits {
+        static constexpr std::adopt_lock_t adopt_lock = std::adopt_lock;
+    };
+
     /**
      * A base class to make derived class non-copyable.
      * 
@@ -269,98 +360,2431 @@ namespace mkg {
     using exclusive_accessor = accessor<std::add_lvalue_reference_t<NonConcurrentType>, LockableType, LockType>;
 
     /**
-     * A wrapper type to protect a `NonConcurrentType` via locking a `LockableType`
-     * via;
-     * 
-     * - `SharedLockType` when read only access
-     * - `ExclusiveLockType` when read & write access
+     * An accessor type which holds a private, immutable copy (snapshot) of a resource instead of a lock.
      * 
-     * is requested.
+     * Snapshot accessors are handed out by lock-free read paths. As the accessor owns the snapshot,
+     * it never blocks writers and stays valid regardless of what happens to the original resource.
      * 
-     * @tparam NonConcurrentType A non thread-safe type to wrap
-     * @tparam LockableType A type which satisfies the `BasicSharedLockable` named requirement (eg. std::shared_mutex)
-     * @tparam SharedLockType A RAII type which will be used to lock the `Lockable` when read access is requested (eg. std::shared_lock)
-     * @tparam ExclusiveLockType A RAII type which will be used to lock the `Lockable` when write access is requested (eg. std::unique_lock)
+     * @tparam NonConcurrentType Type of the snapshot
      */
-    template<typename NonConcurrentType, basic_shared_lockable LockableType, 
-        template <typename...> typename SharedLockType, 
-        template <typename...> typename ExclusiveLockType >
-    class concurrent {
+    template<typename NonConcurrentType>
+    class snapshot_accessor : private noncopyable {
     public:
-        using shared_accessor_t = shared_accessor<NonConcurrentType, LockableType, SharedLockType>;
-        using exclusive_accessor_t = exclusive_accessor<NonConcurrentType, LockableType, ExclusiveLockType>;
 
         /**
-         * @brief Default constructor
-         * 
-         * Instantiates the `NonConcurrentType` by invoking its' default constructor.
+         * @brief Snapshot accessor object constructor
          * 
-         * @exception noexcept if `NonConcurrentType` is `NoThrowDefaultConstructible`
+         * @param value Snapshot of the resource
          */
-        concurrent() 
-            noexcept(std::is_nothrow_default_constructible_v<NonConcurrentType>) 
-            requires (std::is_default_constructible_v<NonConcurrentType>)
-            : resource{}    
+        constexpr explicit snapshot_accessor(NonConcurrentType value)
+            noexcept(std::is_nothrow_move_constructible_v<NonConcurrentType>)
+            : snapshot(std::move(value))
         {}
 
         /**
-         * @brief Copy constructor (from wrapped type)
-         * 
-         * Instantiates the `NonConcurrentType` by invoking its' copy constructor.
+         * @brief Class member access operator overload to behave as if
+         * instance of `snapshot_accessor` class is a pointer to the snapshot.
          * 
-         * @exception noexcept if `NonConcurrentType` is `NoThrowCopyConstructible`
+         * @return Pointer to the immutable snapshot
          */
-        explicit concurrent(const NonConcurrentType& value) 
-            noexcept(std::is_nothrow_copy_constructible_v<NonConcurrentType>) 
-            requires (std::is_copy_constructible_v<NonConcurrentType>)
-            : resource(value)    
-        {}
+        inline const NonConcurrentType * operator->() const noexcept { return &snapshot; }
 
         /**
-         * @brief Move constructor (from wrapped type)
+         * Dereference (star) operator overload
          * 
-         * Instantiates the `NonConcurrentType` by invoking its' move constructor.
+         * @return const reference to the snapshot
+         */
+        inline const NonConcurrentType & operator*() const noexcept { return snapshot; }
+    private:
+        NonConcurrentType snapshot;
+    };
+
+    /**
+     * An accessor type which holds an upgrade lock of an `upgradeable_lockable` object. Grants read-only access
+     * to the resource, while it can be upgraded to read & write (exclusive) access in place, without releasing
+     * the lock in between. Other upgradeable accessors and writers are excluded during the accessor's lifetime.
+     * 
+     * @tparam NonConcurrentType Type of the wrapped resource
+     * @tparam LockableType Type of the `upgradeable_lockable` object
+     */
+    template<typename NonConcurrentType, upgradeable_lockable LockableType>
+    class upgradeable_accessor : private noncopyable {
+    public:
+
+        /**
+         * An accessor type which holds the upgraded (exclusive) lock of an `upgradeable_accessor`. The lock 
+         * is downgraded back to an upgrade lock when the object is destroyed.
+         */
+        class upgraded_accessor : private noncopyable {
+        public:
+            explicit upgraded_accessor(LockableType & lockable, NonConcurrentType & resource)
+                : lockable(lockable), locked_resource(resource)
+            {
+                lockable.unlock_upgrade_and_lock();
+            }
+
+            ~upgraded_accessor() { lockable.unlock_and_lock_upgrade(); }
+
+            /**
+             * @brief Class member access operator overload to behave as if
+             * instance of `upgraded_accessor` class is a pointer to the resource.
+             */
+            inline NonConcurrentType * operator->() noexcept { return &locked_resource; }
+
+            /**
+             * Dereference (star) operator overload
+             * 
+             * @return reference to the resource
+             */
+            inline NonConcurrentType & operator*() noexcept { return locked_resource; }
+        private:
+            LockableType & lockable;
+            NonConcurrentType & locked_resource;
+        };
+
+        /**
+         * @brief Upgradeable accessor object constructor
          * 
-         * @exception noexcept if `NonConcurrentType` is `NoThrowMoveConstructible`
+         * @param lockable  Lockable, which will be upgrade-locked during the access
+         * @param resource  Resource to grant desired access to
          */
-        explicit concurrent(NonConcurrentType&& value) 
-            noexcept(std::is_nothrow_move_constructible_v<NonConcurrentType>) 
-            requires (std::is_move_constructible_v<NonConcurrentType>)
-            : resource(std::move(value))    
+        explicit upgradeable_accessor(LockableType & lockable, NonConcurrentType & resource)
+            : lockable(&lockable), locked_resource(resource)
+        {
+            lockable.lock_upgrade();
+        }
+
+        upgradeable_accessor(upgradeable_accessor && other) noexcept
+            : lockable(std::exchange(other.lockable, nullptr)), locked_resource(other.locked_resource)
         {}
 
+        ~upgradeable_accessor() {
+            if(lockable) {
+                lockable->unlock_upgrade();
+            }
+        }
+
         /**
-         * @brief Destructor
+         * @brief Atomically upgrade to exclusive access. Waits until all shared locks are released.
          * 
-         * @exception noexcept if `NonConcurrentType` is `NoThrowDestructible`
+         * @return upgraded_accessor Read & write accessor, which downgrades back on destruction
          */
-        ~concurrent() noexcept(std::is_nothrow_destructible_v<NonConcurrentType>) = default;
+        [[nodiscard]] upgraded_accessor upgrade() { return upgraded_accessor{ *lockable, locked_resource }; }
 
+        /**
+         * @brief Class member access operator overload to behave as if
+         * instance of `upgradeable_accessor` class is a pointer to the resource.
+         */
+        inline const NonConcurrentType * operator->() const noexcept { return &locked_resource; }
 
         /**
-         * @brief Get read-only (shared) access to underlying wrapped object. Access object will guarantee
-         * `Lockable` object will be locked via `SharedLockType` from beginning to end of the 
-         * returned accessor object.
+         * Dereference (star) operator overload
          * 
-         * @return shared_accessor_t Read-only (shared) accessor object to the wrapped object 
+         * @return const reference to the resource
          */
-        decltype(auto) read_access_handle() const noexcept { return shared_accessor_t{ lockable, resource }; }
+        inline const NonConcurrentType & operator*() const noexcept { return locked_resource; }
+    private:
+        LockableType * lockable;
+        NonConcurrentType & locked_resource;
+    };
+
+    /**
+     * A `Lockable` decorator which aligns (and pads) the decorated `LockableType` to its own cache line(s).
+     * 
+     * Using it as the `LockableType` of a `concurrent` keeps lock acquisitions from invalidating the 
+     * cache lines of the wrapped resource, and aligns the whole `concurrent` object to a cache line, 
+     * so neighbouring instances (eg. in an array) do not false-share either.
+     * 
+     * @tparam LockableType Type of the `Lockable` object to decorate, must not be final
+     */
+    template<typename LockableType>
+    struct alignas(cache_line_size) cache_aligned : LockableType {};
 
+    namespace detail {
         /**
-         * @brief Get write (exclusive) access to underlying wrapped object. Access object will guarantee
-         * `Lockable` object will be locked via `ExclusiveLockType` from beginning to end of the 
-         * returned accessor object.
-         * 
-         * @exception Exception-safe
-         * 
-         * @return exclusive_accessor_t Read & write (exclusive) accessor object to the wrapped object 
+         * @brief Hint the processor that the caller is busy-waiting.
          */
-        decltype(auto) write_access_handle() noexcept { return exclusive_accessor_t{ lockable, resource }; }
-        
+        inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield" ::: "memory");
+#endif
+        }
+
+        /**
+         * @brief A small, stable, process-wide unique index of the calling thread. Used to spread
+         * per-thread state over stripes.
+         */
+        inline std::size_t this_thread_index() noexcept {
+            static std::atomic<std::size_t> next_index = {0};
+            thread_local const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+    }
+
+#if !defined(MKG_CONCURRENT_INSTRUMENTATION)
+    /**
+     * Set to 0 to compile `instrumented` lockables down to their undecorated `LockableType`.
+     */
+#   define MKG_CONCURRENT_INSTRUMENTATION 1
+#endif
+
+    /**
+     * Lock acquisition statistics of a single `instrumented` lockable, split by access type.
+     */
+    struct lock_metrics {
+        struct counters {
+            /** Amount of successful acquisitions */
+            std::uint64_t acquisitions = 0;
+            /** Amount of acquisitions which could not be granted immediately */
+            std::uint64_t contended_acquisitions = 0;
+            /** Total time spent waiting for the lock */
+            std::chrono::nanoseconds wait_time = {};
+            /** Longest single wait for the lock (for `exclusive`, the worst observed writer starvation) */
+            std::chrono::nanoseconds max_wait = {};
+            /** Total time the lock was held (eg. from accessor construction to destruction) */
+            std::chrono::nanoseconds hold_time = {};
+        };
+
+        counters shared;
+        counters exclusive;
+    };
+
+    /**
+     * Checks whether given type T reports `lock_metrics`.
+     * 
+     * @tparam T Type to check
+     */
+    template<typename T>
+    concept instrumented_lockable = requires (const T a) {
+        { a.metrics() } -> std::same_as<lock_metrics>;
+    };
+
+    /**
+     * A `Lockable` decorator which records contention and hold-time statistics (`lock_metrics`) of the 
+     * decorated `LockableType`. Statistics are accumulated in per-thread stripes (each on its own 
+     * cache line), so recording them does not add contention of its own.
+     * 
+     * Acquisitions are considered contended when the non-blocking `try_` variant of the operation fails,
+     * so contention is only detected for `LockableType`s which provide it.
+     * 
+     * @tparam LockableType A type which satisfies the `BasicLockable` named requirement (eg. std::shared_mutex)
+     * @tparam Enabled Records statistics if true, otherwise the decorator is a plain `LockableType`
+     * @tparam StripeCount Amount of statistics stripes
+     */
+    template<basic_lockable LockableType, bool Enabled = MKG_CONCURRENT_INSTRUMENTATION, std::size_t StripeCount = 16>
+    class instrumented {
+        using clock = std::chrono::steady_clock;
+    public:
+        void lock() {
+            if constexpr (mkg::lockable<LockableType>) {
+                if(underlying.try_lock()) {
+                    return exclusive_acquired(clock::duration::zero(), false);
+                }
+            }
+            const auto start = clock::now();
+            underlying.lock();
+            exclusive_acquired(clock::now() - start, mkg::lockable<LockableType>);
+        }
+
+        bool try_lock() requires mkg::lockable<LockableType> {
+            return underlying.try_lock() ? (exclusive_acquired(clock::duration::zero(), false), true) : false;
+        }
+
+        template<typename Duration>
+        bool try_lock_for(const Duration & duration) requires timed_lockable<LockableType> {
+            return try_lock_until(clock::now() + duration);
+        }
+
+        template<typename TimePoint>
+        bool try_lock_until(const TimePoint & time_point) requires timed_lockable<LockableType> {
+            if(underlying.try_lock()) {
+                return exclusive_acquired(clock::duration::zero(), false), true;
+            }
+            const auto start = clock::now();
+            return underlying.try_lock_until(time_point) ? (exclusive_acquired(clock::now() - start, true), true) : false;
+        }
+
+        void unlock() {
+            stripe().exclusive.hold_time.fetch_add(elapsed_since(exclusive_since), std::memory_order_relaxed);
+            underlying.unlock();
+        }
+
+        void lock_shared() requires basic_shared_lockable<LockableType> {
+            if constexpr (shared_lockable<LockableType>) {
+                if(underlying.try_lock_shared()) {
+                    return shared_acquired(clock::duration::zero(), false);
+                }
+            }
+            const auto start = clock::now();
+            underlying.lock_shared();
+            shared_acquired(clock::now() - start, shared_lockable<LockableType>);
+        }
+
+        bool try_lock_shared() requires shared_lockable<LockableType> {
+            return underlying.try_lock_shared() ? (shared_acquired(clock::duration::zero(), false), true) : false;
+        }
+
+        template<typename Duration>
+        bool try_lock_shared_for(const Duration & duration) requires shared_timed_lockable<LockableType> {
+            return try_lock_shared_until(clock::now() + duration);
+        }
+
+        template<typename TimePoint>
+        bool try_lock_shared_until(const TimePoint & time_point) requires shared_timed_lockable<LockableType> {
+            if(underlying.try_lock_shared()) {
+                return shared_acquired(clock::duration::zero(), false), true;
+            }
+            const auto start = clock::now();
+            return underlying.try_lock_shared_until(time_point) ? (shared_acquired(clock::now() - start, true), true) : false;
+        }
+
+        void unlock_shared() requires basic_shared_lockable<LockableType> {
+            auto & current = stripe();
+            current.shared.hold_time.fetch_add(elapsed_since(origin), std::memory_order_relaxed);
+            current.shared_releases.fetch_add(1, std::memory_order_relaxed);
+            underlying.unlock_shared();
+        }
+
+        /**
+         * @brief Snapshot of the statistics recorded so far. Not atomic with respect to concurrent 
+         * acquisitions; shared locks which are still held contribute the time they have been held for.
+         */
+        lock_metrics metrics() const noexcept {
+            lock_metrics result;
+            std::int64_t shared_hold_balance = 0;
+            std::uint64_t shared_releases = 0;
+            for(const auto & current : stripes) {
+                collect(current.shared, result.shared);
+                collect(current.exclusive, result.exclusive);
+                shared_hold_balance += current.shared.hold_time.load(std::memory_order_relaxed);
+                shared_releases += current.shared_releases.load(std::memory_order_relaxed);
+            }
+            const auto held = static_cast<std::int64_t>(result.shared.acquisitions - shared_releases);
+            result.shared.hold_time = std::chrono::nanoseconds{ shared_hold_balance + held * elapsed_since(origin) };
+            return result;
+        }
+
     private:
-        NonConcurrentType resource;
-        mutable LockableType lockable; 
+        struct atomic_counters {
+            std::atomic<std::uint64_t> acquisitions = {0};
+            std::atomic<std::uint64_t> contended_acquisitions = {0};
+            std::atomic<std::int64_t> wait_time = {0};
+            std::atomic<std::int64_t> max_wait = {0};
+            /**
+             * For shared locks, the sum of release minus acquisition timestamps (relative to `origin`),
+             * as several threads may hold the lock at once.
+             */
+            std::atomic<std::int64_t> hold_time = {0};
+        };
+
+        struct alignas(cache_line_size) metrics_stripe {
+            atomic_counters shared;
+            atomic_counters exclusive;
+            std::atomic<std::uint64_t> shared_releases = {0};
+        };
+
+        metrics_stripe & stripe() noexcept { return stripes[detail::this_thread_index() % StripeCount]; }
+
+        static std::int64_t elapsed_since(clock::time_point since) noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - since).count();
+        }
+
+        static void record(atomic_counters & counters, clock::duration wait, bool contended) noexcept {
+            counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+            if(contended) {
+                counters.contended_acquisitions.fetch_add(1, std::memory_order_relaxed);
+                const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+                counters.wait_time.fetch_add(waited, std::memory_order_relaxed);
+                // The stripe is (mostly) private to the calling thread, so this rarely loops.
+                for(auto longest = counters.max_wait.load(std::memory_order_relaxed); waited > longest 
+                    && !counters.max_wait.compare_exchange_weak(longest, waited, std::memory_order_relaxed);) {}
+            }
+        }
+
+        static void collect(const atomic_counters & from, lock_metrics::counters & to) noexcept {
+            to.acquisitions += from.acquisitions.load(std::memory_order_relaxed);
+            to.contended_acquisitions += from.contended_acquisitions.load(std::memory_order_relaxed);
+            to.wait_time += std::chrono::nanoseconds{ from.wait_time.load(std::memory_order_relaxed) };
+            to.max_wait = std::max(to.max_wait, std::chrono::nanoseconds{ from.max_wait.load(std::memory_order_relaxed) });
+            to.hold_time += std::chrono::nanoseconds{ from.hold_time.load(std::memory_order_relaxed) };
+        }
+
+        void exclusive_acquired(clock::duration wait, bool contended) noexcept {
+            record(stripe().exclusive, wait, contended);
+            // Only written by the exclusive owner.
+            exclusive_since = clock::now();
+        }
+
+        void shared_acquired(clock::duration wait, bool contended) noexcept {
+            auto & current = stripe();
+            record(current.shared, wait, contended);
+            current.shared.hold_time.fetch_sub(elapsed_since(origin), std::memory_order_relaxed);
+        }
+
+        LockableType underlying;
+        const clock::time_point origin = clock::now();
+        clock::time_point exclusive_since;
+        std::array<metrics_stripe, StripeCount> stripes;
+    };
+
+    /**
+     * Disabled `instrumented` decorator; behaves exactly like `LockableType`, and reports empty metrics.
+     */
+    template<basic_lockable LockableType, std::size_t StripeCount>
+    class instrumented<LockableType, false, StripeCount> : public LockableType {
+    public:
+        lock_metrics metrics() const noexcept { return {}; }
+    };
+
+    /**
+     * A `Lockable` decorator which maintains a version (sequence) counter alongside the decorated 
+     * `LockableType`. The version is incremented right after an exclusive lock is acquired, and right
+     * before it is released, so;
+     * 
+     * - an odd version means a writer is (possibly) modifying the protected resource
+     * - an unchanged, even version means no writer has modified the resource in the meantime
+     * 
+     * Shared lock operations are forwarded as-is.
+     * 
+     * @tparam LockableType A type which satisfies the `BasicLockable` named requirement (eg. std::shared_mutex)
+     */
+    template<basic_lockable LockableType>
+    class versioned {
+    public:
+        void lock() { underlying.lock(); begin_write(); }
+        void unlock() { end_write(); underlying.unlock(); }
+
+        bool try_lock() requires mkg::lockable<LockableType> { 
+            return underlying.try_lock() ? (begin_write(), true) : false; 
+        }
+
+        template<typename Duration>
+        bool try_lock_for(const Duration & duration) requires timed_lockable<LockableType> {
+            return underlying.try_lock_for(duration) ? (begin_write(), true) : false;
+        }
+
+        template<typename TimePoint>
+        bool try_lock_until(const TimePoint & time_point) requires timed_lockable<LockableType> {
+            return underlying.try_lock_until(time_point) ? (begin_write(), true) : false;
+        }
+
+        void lock_shared() requires basic_shared_lockable<LockableType> { underlying.lock_shared(); }
+        void unlock_shared() requires basic_shared_lockable<LockableType> { underlying.unlock_shared(); }
+        bool try_lock_shared() requires shared_lockable<LockableType> { return underlying.try_lock_shared(); }
+
+        template<typename Duration>
+        bool try_lock_shared_for(const Duration & duration) requires shared_timed_lockable<LockableType> {
+            return underlying.try_lock_shared_for(duration);
+        }
+
+        template<typename TimePoint>
+        bool try_lock_shared_until(const TimePoint & time_point) requires shared_timed_lockable<LockableType> {
+            return underlying.try_lock_shared_until(time_point);
+        }
+
+        /**
+         * @brief Current version. Reads of the protected resource which are followed by an 
+         * acquire fence are ordered before subsequent `version()` calls.
+         */
+        std::uint64_t version() const noexcept { return sequence.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Statistics of the decorated `LockableType`, if it is instrumented.
+         */
+        lock_metrics metrics() const noexcept requires instrumented_lockable<LockableType> { return underlying.metrics(); }
+
+    private:
+        void begin_write() noexcept {
+            // Only the exclusive owner modifies the sequence, so no RMW is needed.
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        void end_write() noexcept {
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        std::atomic<std::uint64_t> sequence = {0};
+        LockableType underlying;
+    };
+
+    /**
+     * Checks whether given type T exposes a sequence counter, which changes whenever it is locked or 
+     * unlocked exclusively (see `versioned`).
+     * 
+     * @tparam T Type to check
+     */
+    template<typename T>
+    concept versioned_lockable = requires (const T a) {
+        { a.version() } -> std::same_as<std::uint64_t>;
+    };
+
+    /**
+     * Checks whether given type T wants to know the call site of each acquisition made through `concurrent`
+     * (eg. for lock order checks, see `ranked`). The call site is announced right before locking.
+     * 
+     * @tparam T Type to check
+     */
+    template<typename T>
+    concept ranked_lockable = requires (T a, const std::source_location & site, std::size_t rank) {
+        a.acquiring_from(site);
+        a.set_rank(rank);
+    };
+
+    namespace detail {
+        /**
+         * A type-erased mutation of a resource, which a `combining_lockable` may run on behalf of the 
+         * thread which posted it. Failures are stored, to be rethrown in the posting thread.
+         */
+        struct combining_operation {
+            void (*run)(combining_operation &);
+            std::exception_ptr failure = {};
+        };
+
+        /**
+         * A `combining_operation` which invokes `Fn` with `Resource`, and keeps its result.
+         */
+        template<typename Fn, typename Resource>
+        class bound_operation : public combining_operation {
+        public:
+            using result_type = std::invoke_result_t<Fn, Resource &>;
+
+            bound_operation(std::remove_reference_t<Fn> & fn, Resource & resource) noexcept
+                : combining_operation{ &execute }, fn(fn), resource(resource)
+            {}
+
+            /**
+             * @brief The result of `Fn`, or rethrows the exception it has thrown.
+             */
+            result_type result() && {
+                if(failure) {
+                    std::rethrow_exception(failure);
+                }
+                if constexpr (std::is_reference_v<result_type>) {
+                    return static_cast<result_type>(**value);
+                } else if constexpr (!std::is_void_v<result_type>) {
+                    return std::move(*value);
+                }
+            }
+        private:
+            using stored_type = std::conditional_t<std::is_reference_v<result_type>, 
+                std::add_pointer_t<std::remove_reference_t<result_type>>, result_type>;
+
+            static void execute(combining_operation & self) {
+                auto & operation = static_cast<bound_operation &>(self);
+                if constexpr (std::is_void_v<result_type>) {
+                    std::invoke(std::forward<Fn>(operation.fn), operation.resource);
+                } else if constexpr (std::is_reference_v<result_type>) {
+                    operation.value.emplace(std::addressof(std::invoke(std::forward<Fn>(operation.fn), operation.resource)));
+                } else {
+                    operation.value.emplace(std::invoke(std::forward<Fn>(operation.fn), operation.resource));
+                }
+            }
+
+            std::remove_reference_t<Fn> & fn;
+            Resource & resource;
+            [[no_unique_address]] std::conditional_t<std::is_void_v<result_type>, std::monostate, std::optional<stored_type>> value;
+        };
+    }
+
+    /**
+     * A `Lockable` type which can run `combining_operation`s under its exclusive lock, possibly batched 
+     * with the operations of other threads (see `flat_combining`). `concurrent::write(fn)` posts `fn`
+     * to such lockables instead of acquiring an accessor.
+     */
+    template<typename T>
+    concept combining_lockable = basic_lockable<T> && requires (T a, detail::combining_operation & operation) {
+        a.combine(operation);
     };
 
+    namespace detail {
+        /**
+         * A pending lock request of an `async_lockable`; queued when the lock is not available, 
+         * and `resume`d once the lock has been granted to it.
+         */
+        struct async_waiter {
+            bool exclusive = false;
+            void (*resume)(async_waiter &) = nullptr;
+            async_waiter * next = nullptr;
+        };
+    }
+
+    /**
+     * A `Lockable` type which can queue lock requests instead of blocking the calling thread 
+     * (see `async_shared_mutex`). Required by `concurrent::async_read_access()` and `async_write_access()`.
+     * 
+     * `lock_async(waiter)` must either acquire the lock right away and return true, or queue `waiter` and 
+     * return false, in which case `waiter.resume` is invoked (from an unlocking thread) after the lock 
+     * has been acquired on its behalf.
+     */
+    template<typename T>
+    concept async_lockable = shared_lockable<T> && mkg::lockable<T> && requires (T a, detail::async_waiter & waiter) {
+        { a.lock_async(waiter) } -> std::same_as<bool>;
+    };
+
+    namespace detail {
+        /**
+         * Grants library internals (eg. `lock_all`) access to the private parts of `concurrent`.
+         */
+        struct concurrent_access {
+            template<typename ConcurrentType>
+            static auto & lockable(const ConcurrentType & resource) noexcept { return resource.lockable; }
+
+            template<typename ConcurrentType>
+            static decltype(auto) adopt_shared(const ConcurrentType & resource) { return resource.adopt_shared(); }
+
+            template<typename ConcurrentType>
+            static decltype(auto) adopt_exclusive(ConcurrentType & resource) { return resource.adopt_exclusive(); }
+        };
+
+        /**
+         * @brief Rank of `lockable` in `lock_all` order: its `rank()` if it is ranked (see `ranked`), 
+         * otherwise it comes after every ranked lock.
+         */
+        template<typename LockableType>
+        std::size_t lock_order_rank([[maybe_unused]] const LockableType & lockable) noexcept {
+            if constexpr (requires { { lockable.rank() } -> std::convertible_to<std::size_t>; }) {
+                return lockable.rank();
+            } else {
+                return std::numeric_limits<std::size_t>::max();
+            }
+        }
+
+        /**
+         * @brief Tell a `ranked_lockable` where the upcoming acquisition comes from; no-op otherwise.
+         */
+        template<typename LockableType>
+        void announce_acquisition([[maybe_unused]] LockableType & lockable, [[maybe_unused]] const std::source_location & site) noexcept {
+            if constexpr (ranked_lockable<LockableType>) {
+                lockable.acquiring_from(site);
+            }
+        }
+    }
+
+    /**
+     * Default executor for the async accessors; resumes the coroutine on the thread which granted the lock.
+     */
+    struct inline_executor {
+        void operator()(std::coroutine_handle<> coroutine) const { coroutine.resume(); }
+    };
+
+    /**
+     * An awaitable which acquires an accessor to `ConcurrentType` without blocking the awaiting thread. 
+     * If the lock is not available, the coroutine is suspended and queued on the `async_lockable`, then 
+     * handed to `Executor` for resumption once the lock has been granted.
+     * 
+     * @tparam ConcurrentType Type of the `concurrent` resource (const-qualified for read access)
+     * @tparam Executor A callable which accepts a `std::coroutine_handle<>` and arranges it to be resumed
+     */
+    template<typename ConcurrentType, typename Executor>
+    class access_awaitable : private detail::async_waiter, private noncopyable {
+        static constexpr bool is_exclusive = !std::is_const_v<ConcurrentType>;
+    public:
+        using accessor_t = std::conditional_t<is_exclusive, 
+            typename ConcurrentType::exclusive_accessor_t, typename ConcurrentType::shared_accessor_t>;
+
+        access_awaitable(ConcurrentType & resource, Executor executor)
+            noexcept(std::is_nothrow_move_constructible_v<Executor>)
+            : detail::async_waiter{ is_exclusive, &resume_coroutine }, resource(resource), executor(std::move(executor))
+        {}
+
+        bool await_ready() {
+            auto & lockable = detail::concurrent_access::lockable(resource);
+            if constexpr (is_exclusive) {
+                return lockable.try_lock();
+            } else {
+                return lockable.try_lock_shared();
+            }
+        }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            coroutine = awaiting;
+            // Once queued, we might be resumed (and destroyed) on another thread at any time.
+            return !detail::concurrent_access::lockable(resource).lock_async(*this);
+        }
+
+        accessor_t await_resume() {
+            if constexpr (is_exclusive) {
+                return detail::concurrent_access::adopt_exclusive(resource);
+            } else {
+                return detail::concurrent_access::adopt_shared(resource);
+            }
+        }
+    private:
+        static void resume_coroutine(detail::async_waiter & waiter) {
+            auto & self = static_cast<access_awaitable &>(waiter);
+            std::invoke(self.executor, self.coroutine);
+        }
+
+        ConcurrentType & resource;
+        [[no_unique_address]] Executor executor;
+        std::coroutine_handle<> coroutine = {};
+    };
+
+    /**
+     * A wrapper type to protect a `NonConcurrentType` via locking a `LockableType`
+     * via;
+     * 
+     * - `SharedLockType` when read only access
+     * - `ExclusiveLockType` when read & write access
+     * 
+     * is requested.
+     * 
+     * @tparam NonConcurrentType A non thread-safe type to wrap
+     * @tparam LockableType A type which satisfies the `BasicSharedLockable` named requirement (eg. std::shared_mutex)
+     * @tparam SharedLockType A RAII type which will be used to lock the `Lockable` when read access is requested (eg. std::shared_lock)
+     * @tparam ExclusiveLockType A RAII type which will be used to lock the `Lockable` when write access is requested (eg. std::unique_lock)
+     */
+    template<typename NonConcurrentType, basic_shared_lockable LockableType, 
+        template <typename...> typename SharedLockType, 
+        template <typename...> typename ExclusiveLockType >
+    class concurrent {
+    public:
+        using value_type = NonConcurrentType;
+        using shared_accessor_t = shared_accessor<NonConcurrentType, LockableType, SharedLockType>;
+        using exclusive_accessor_t = exclusive_accessor<NonConcurrentType, LockableType, ExclusiveLockType>;
+
+        /**
+         * @brief Default constructor
+         * 
+         * Instantiates the `NonConcurrentType` by invoking its' default constructor.
+         * 
+         * @exception noexcept if `NonConcurrentType` is `NoThrowDefaultConstructible`
+         */
+        concurrent() 
+            noexcept(std::is_nothrow_default_constructible_v<NonConcurrentType>) 
+            requires (std::is_default_constructible_v<NonConcurrentType>)
+            : resource{}    
+        {}
+
+        /**
+         * @brief Copy constructor (from wrapped type)
+         * 
+         * Instantiates the `NonConcurrentType` by invoking its' copy constructor.
+         * 
+         * @exception noexcept if `NonConcurrentType` is `NoThrowCopyConstructible`
+         */
+        explicit concurrent(const NonConcurrentType& value) 
+            noexcept(std::is_nothrow_copy_constructible_v<NonConcurrentType>) 
+            requires (std::is_copy_constructible_v<NonConcurrentType>)
+            : resource(value)    
+        {}
+
+        /**
+         * @brief Move constructor (from wrapped type)
+         * 
+         * Instantiates the `NonConcurrentType` by invoking its' move constructor.
+         * 
+         * @exception noexcept if `NonConcurrentType` is `NoThrowMoveConstructible`
+         */
+        explicit concurrent(NonConcurrentType&& value) 
+            noexcept(std::is_nothrow_move_constructible_v<NonConcurrentType>) 
+            requires (std::is_move_constructible_v<NonConcurrentType>)
+            : resource(std::move(value))    
+        {}
+
+        /**
+         * @brief Allocator-extended constructor
+         * 
+         * Instantiates the `NonConcurrentType` from `args` by uses-allocator construction, so `allocator` 
+         * (eg. a `std::pmr::memory_resource *`, see `arena`) is forwarded into the wrapped container.
+         */
+        template<typename Allocator, typename... Args>
+        requires std::uses_allocator_v<NonConcurrentType, Allocator>
+        concurrent(std::allocator_arg_t, const Allocator & allocator, Args && ... args)
+            : resource(std::make_obj_using_allocator<NonConcurrentType>(allocator, std::forward<Args>(args)...))
+        {}
+
+        /**
+         * @brief Destructor
+         * 
+         * @exception noexcept if `NonConcurrentType` is `NoThrowDestructible`
+         */
+        ~concurrent() noexcept(std::is_nothrow_destructible_v<NonConcurrentType>) = default;
+
+
+        /**
+         * @brief Get read-only (shared) access to underlying wrapped object. Access object will guarantee
+         * `Lockable` object will be locked via `SharedLockType` from beginning to end of the 
+         * returned accessor object.
+         * 
+         * @return shared_accessor_t Read-only (shared) accessor object to the wrapped object 
+         */
+        decltype(auto) read_access_handle(const std::source_location & site = std::source_location::current()) const noexcept { 
+            announce(site);
+            return shared_accessor_t{ lockable, resource }; 
+        }
+
+        /**
+         * @brief Get write (exclusive) access to underlying wrapped object. Access object will guarantee
+         * `Lockable` object will be locked via `ExclusiveLockType` from beginning to end of the 
+         * returned accessor object.
+         * 
+         * @exception Exception-safe
+         * 
+         * @return exclusive_accessor_t Read & write (exclusive) accessor object to the wrapped object 
+         */
+        decltype(auto) write_access_handle(const std::source_location & site = std::source_location::current()) noexcept { 
+            announce(site);
+            return exclusive_accessor_t{ lockable, resource }; 
+        }
+
+        /**
+         * @brief Invoke `fn` with read-only access to the wrapped object, under a shared lock.
+         * The lock is held for the duration of the call only, which keeps the critical section minimal.
+         * 
+         * @note The result is returned as is; do not return references into the resource.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, const NonConcurrentType &>
+        std::invoke_result_t<Fn, const NonConcurrentType &> read(Fn && fn, const std::source_location & site = std::source_location::current()) const {
+            auto accessor = read_access_handle(site);
+            return std::invoke(std::forward<Fn>(fn), *accessor);
+        }
+
+        /**
+         * @brief Invoke `fn` with read & write access to the wrapped object, under an exclusive lock.
+         * The lock is held for the duration of the call only, which keeps the critical section minimal.
+         * 
+         * If `LockableType` is a `combining_lockable`, `fn` may be run by another thread, batched
+         * with other pending writes; this call returns once `fn` has been run.
+         * 
+         * @note The result is returned as is; do not return references into the resource.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, NonConcurrentType &>
+        std::invoke_result_t<Fn, NonConcurrentType &> write(Fn && fn, const std::source_location & site = std::source_location::current()) {
+            using result_type = std::invoke_result_t<Fn, NonConcurrentType &>;
+            if constexpr (combining_lockable<LockableType> && (std::is_void_v<result_type> || 
+                std::is_reference_v<result_type> || std::is_move_constructible_v<result_type>)) {
+                detail::bound_operation<Fn, NonConcurrentType> operation{ fn, resource };
+                lockable.combine(operation);
+                return std::move(operation).result();
+            } else {
+                auto accessor = write_access_handle(site);
+                return std::invoke(std::forward<Fn>(fn), *accessor);
+            }
+        }
+
+        /**
+         * @brief Invoke `fn` with read-only access to the wrapped object, without taking the shared lock. 
+         * The version of the `versioned` lock is checked before and after the call; if a writer intervened, 
+         * the call is retried, and after `optimistic_read_attempts` failed attempts, it is run under the 
+         * shared lock instead (see `read(fn)`).
+         * 
+         * @note `fn` runs concurrently with writers, so it may observe the resource in an inconsistent state;
+         * its result is discarded in that case. Thus `fn` must only read the resource, must not follow pointers
+         * or iterators which a writer may invalidate (eg. nodes of a std::map, elements of a growing std::vector),
+         * must not loop depending on what it reads, and must not have side effects. Scalar members and fixed-size
+         * storage are fine.
+         * 
+         * @return The result of `fn`, which must not be a reference
+         */
+        template<typename Fn>
+        requires versioned_lockable<LockableType> && std::invocable<Fn, const NonConcurrentType &> 
+            && (!std::is_reference_v<std::invoke_result_t<Fn, const NonConcurrentType &>>)
+        std::invoke_result_t<Fn, const NonConcurrentType &> optimistic_read(Fn && fn) const {
+            for(std::size_t attempt = 0; attempt < optimistic_read_attempts; ++attempt) {
+                const auto before = lockable.version();
+                if(before & 1) {
+                    // A writer is active, no use in reading.
+                    detail::cpu_relax();
+                    continue;
+                }
+                // This read races with writers by design; results of inconsistent reads are discarded below.
+                if constexpr (std::is_void_v<std::invoke_result_t<Fn, const NonConcurrentType &>>) {
+                    std::invoke(fn, resource);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(lockable.version() == before) {
+                        return;
+                    }
+                } else {
+                    auto result = std::invoke(fn, resource);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(lockable.version() == before) {
+                        return result;
+                    }
+                }
+            }
+            return read(std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief Amount of optimistic attempts of `optimistic_read(fn)`, before it falls back to the shared lock
+         */
+        static constexpr std::size_t optimistic_read_attempts = 4;
+
+        /**
+         * @brief Generation of the wrapped object; changes whenever it is locked or unlocked exclusively,
+         * so an unchanged, even version means the object was not modified in between (see `versioned`).
+         */
+        std::uint64_t version() const noexcept requires versioned_lockable<LockableType> { return lockable.version(); }
+
+        /**
+         * @brief Replace the wrapped object with `replacement`, and move the previous one out. The exclusive
+         * lock is held for a swap only (a pointer swap for containers), so the previous object can be 
+         * processed without holding the lock.
+         * 
+         * @return NonConcurrentType The previous object
+         */
+        NonConcurrentType exchange(NonConcurrentType replacement) 
+            requires std::is_move_constructible_v<NonConcurrentType> && std::is_swappable_v<NonConcurrentType> {
+            swap(replacement);
+            return replacement;
+        }
+
+        /**
+         * @brief Move the wrapped object out, leaving a default constructed one behind (see `exchange()`).
+         * 
+         * @return NonConcurrentType The previous object
+         */
+        NonConcurrentType take() 
+            requires std::is_default_constructible_v<NonConcurrentType> && std::is_move_constructible_v<NonConcurrentType> 
+                && std::is_swappable_v<NonConcurrentType> {
+            return exchange(NonConcurrentType{});
+        }
+
+        /**
+         * @brief Swap the wrapped object with `other` under the exclusive lock. Swapping with an emptied, 
+         * but still allocated buffer drains the resource without allocations (ping-pong buffering):
+         * 
+         * ~~~cpp
+         * buffer.clear();        // keeps the capacity
+         * queue.swap(buffer);    // lock held for a pointer swap
+         * process(buffer);       // unlocked
+         * ~~~
+         */
+        void swap(NonConcurrentType & other) requires std::is_swappable_v<NonConcurrentType> {
+            auto accessor = write_access_handle();
+            using std::swap;
+            swap(*accessor, other);
+        }
+
+        /**
+         * @brief Get upgradeable access to underlying wrapped object. The accessor grants read-only access while
+         * allowing concurrent readers, and can be upgraded to write access in place via `upgrade()`, which 
+         * removes the need to release the read lock and re-check the state after acquiring a write lock.
+         * 
+         * @return upgradeable_accessor Upgradeable accessor object to the wrapped object
+         */
+        decltype(auto) upgrade_access_handle() requires upgradeable_lockable<LockableType> { 
+            return upgradeable_accessor<NonConcurrentType, LockableType>{ lockable, resource }; 
+        }
+
+        /**
+         * @brief Get read-only (shared) access to underlying wrapped object from a coroutine, without 
+         * blocking the thread: `auto reader = co_await resource.async_read_access();`
+         * 
+         * @param executor Resumes the coroutine if it had to wait (eg. by posting it to a thread pool)
+         * @return An awaitable, which yields a `shared_accessor_t`
+         */
+        template<typename Executor = inline_executor>
+        requires async_lockable<LockableType> && std::invocable<Executor &, std::coroutine_handle<>>
+        access_awaitable<const concurrent, Executor> async_read_access(Executor executor = {}) const {
+            return access_awaitable<const concurrent, Executor>{ *this, std::move(executor) };
+        }
+
+        /**
+         * @brief Get read & write (exclusive) access to underlying wrapped object from a coroutine, without 
+         * blocking the thread: `auto writer = co_await resource.async_write_access();`
+         * 
+         * @param executor Resumes the coroutine if it had to wait (eg. by posting it to a thread pool)
+         * @return An awaitable, which yields an `exclusive_accessor_t`
+         */
+        template<typename Executor = inline_executor>
+        requires async_lockable<LockableType> && std::invocable<Executor &, std::coroutine_handle<>>
+        access_awaitable<concurrent, Executor> async_write_access(Executor executor = {}) {
+            return access_awaitable<concurrent, Executor>{ *this, std::move(executor) };
+        }
+
+        /**
+         * @brief Try to get read-only (shared) access to underlying wrapped object, without blocking.
+         * 
+         * @return std::optional<shared_accessor_t> Read-only (shared) accessor object, or std::nullopt
+         * if the shared lock could not be acquired immediately
+         */
+        std::optional<shared_accessor_t> try_read_access_handle(const std::source_location & site = std::source_location::current()) const 
+            requires shared_lockable<LockableType> {
+            announce(site);
+            return lockable.try_lock_shared() ? std::optional<shared_accessor_t>{ adopt_shared() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get read-only (shared) access to underlying wrapped object, blocking for at most `duration`.
+         * 
+         * @return std::optional<shared_accessor_t> Read-only (shared) accessor object, or std::nullopt on timeout
+         */
+        template<typename Rep, typename Period>
+        std::optional<shared_accessor_t> try_read_access_handle_for(const std::chrono::duration<Rep, Period> & duration, 
+            const std::source_location & site = std::source_location::current()) const requires shared_timed_lockable<LockableType> {
+            announce(site);
+            return lockable.try_lock_shared_for(duration) ? std::optional<shared_accessor_t>{ adopt_shared() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get read-only (shared) access to underlying wrapped object, blocking until `time_point` at most.
+         * 
+         * @return std::optional<shared_accessor_t> Read-only (shared) accessor object, or std::nullopt on timeout
+         */
+        template<typename Clock, typename Duration>
+        std::optional<shared_accessor_t> try_read_access_handle_until(const std::chrono::time_point<Clock, Duration> & time_point, 
+            const std::source_location & site = std::source_location::current()) const requires shared_timed_lockable<LockableType> {
+            announce(site);
+            return lockable.try_lock_shared_until(time_point) ? std::optional<shared_accessor_t>{ adopt_shared() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get write (exclusive) access to underlying wrapped object, without blocking.
+         * 
+         * @return std::optional<exclusive_accessor_t> Read & write (exclusive) accessor object, or std::nullopt
+         * if the exclusive lock could not be acquired immediately
+         */
+        std::optional<exclusive_accessor_t> try_write_access_handle(const std::source_location & site = std::source_location::current()) 
+            requires mkg::lockable<LockableType> {
+            announce(site);
+            return lockable.try_lock() ? std::optional<exclusive_accessor_t>{ adopt_exclusive() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get write (exclusive) access to underlying wrapped object, blocking for at most `duration`.
+         * 
+         * @return std::optional<exclusive_accessor_t> Read & write (exclusive) accessor object, or std::nullopt on timeout
+         */
+        template<typename Rep, typename Period>
+        std::optional<exclusive_accessor_t> try_write_access_handle_for(const std::chrono::duration<Rep, Period> & duration, 
+            const std::source_location & site = std::source_location::current()) requires timed_lockable<LockableType> {
+            announce(site);
+            return lockable.try_lock_for(duration) ? std::optional<exclusive_accessor_t>{ adopt_exclusive() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get write (exclusive) access to underlying wrapped object, blocking until `time_point` at most.
+         * 
+         * @return std::optional<exclusive_accessor_t> Read & write (exclusive) accessor object, or std::nullopt on timeout
+         */
+        template<typename Clock, typename Duration>
+        std::optional<exclusive_accessor_t> try_write_access_handle_until(const std::chrono::time_point<Clock, Duration> & time_point, 
+            const std::source_location & site = std::source_location::current()) requires timed_lockable<LockableType> {
+            announce(site);
+            return lockable.try_lock_until(time_point) ? std::optional<exclusive_accessor_t>{ adopt_exclusive() } : std::nullopt;
+        }
+
+        /**
+         * @brief Invoke `callback` with the `lock_metrics` of this resource's lock. Only available
+         * when `LockableType` is instrumented (see `instrumented`).
+         */
+        template<typename Callback>
+        void export_metrics(Callback && callback) const requires instrumented_lockable<LockableType> {
+            std::forward<Callback>(callback)(lockable.metrics());
+        }
+
+        /**
+         * @brief Assign the rank of this resource's lock at runtime (see `ranked`).
+         */
+        void set_lock_rank(std::size_t rank) noexcept requires ranked_lockable<LockableType> { lockable.set_rank(rank); }
+
+    private:
+        friend struct detail::concurrent_access;
+
+        /**
+         * @brief Tell a `ranked_lockable` where the upcoming acquisition comes from; no-op otherwise.
+         */
+        void announce(const std::source_location & site) const noexcept { detail::announce_acquisition(lockable, site); }
+
+        /**
+         * @brief Wrap the (already acquired) shared lock into an accessor.
+         */
+        shared_accessor_t adopt_shared() const {
+            return shared_accessor_t{ SharedLockType<LockableType>{ lockable, lock_traits<SharedLockType>::adopt_lock }, resource };
+        }
+
+        /**
+         * @brief Wrap the (already acquired) exclusive lock into an accessor.
+         */
+        exclusive_accessor_t adopt_exclusive() {
+            return exclusive_accessor_t{ ExclusiveLockType<LockableType>{ lockable, lock_traits<ExclusiveLockType>::adopt_lock }, resource };
+        }
+
+        NonConcurrentType resource;
+        mutable LockableType lockable; 
+    };
+
+    /**
+     * A private copy of a `concurrent` resource guarded by a `versioned` lock (or of a `seqlocked` one), for a
+     * single thread which reads the resource much more often than it is written. `cached_read()` only compares
+     * the resource's version with the version of the copy; the copy is refreshed through `read_access_handle()`
+     * when a writer has modified the resource since. Steady-state reads do not touch the lock at all.
+     * 
+     * A cache is meant to be owned by one thread (eg. `thread_local`), and must not outlive its resource.
+     * 
+     * ~~~cpp
+     * mkg::concurrent<config, mkg::versioned<std::shared_mutex>> settings;
+     * thread_local mkg::read_cache cache{ settings };
+     * const config & current = cache.cached_read();
+     * ~~~
+     * 
+     * @tparam ConcurrentType A `concurrent` type with a `versioned_lockable` lock and a copyable resource
+     */
+    template<typename ConcurrentType>
+    requires requires (const ConcurrentType & c) { { c.version() } -> std::same_as<std::uint64_t>; } 
+        && std::is_copy_constructible_v<typename ConcurrentType::value_type>
+    class read_cache : private noncopyable {
+    public:
+        using value_type = typename ConcurrentType::value_type;
+
+        explicit read_cache(const ConcurrentType & resource) : resource{ resource } {}
+
+        /**
+         * @brief The cached copy of the resource, refreshed first if the resource has been modified since
+         * it was copied. The reference stays valid until the next call.
+         */
+        const value_type & cached_read() {
+            if(!copy || resource.version() != copied_version) {
+                refresh();
+            }
+            return *copy;
+        }
+
+        const value_type & operator*() { return cached_read(); }
+        const value_type * operator->() { return &cached_read(); }
+
+        /**
+         * @brief Amount of refreshes (copies made) so far.
+         */
+        std::size_t refreshes() const noexcept { return refresh_count; }
+
+    private:
+        void refresh() {
+            // Observed before copying; a write in between only makes the copy newer than its version, which
+            // costs another refresh, but can never leave a stale copy behind (seqlock reads do not exclude writers).
+            copied_version = resource.version();
+            auto read_accessor = resource.read_access_handle();
+            if(copy) {
+                *copy = *read_accessor;
+            } else {
+                copy.emplace(*read_accessor);
+            }
+            ++refresh_count;
+        }
+
+        const ConcurrentType & resource;
+        std::optional<value_type> copy;
+        std::uint64_t copied_version = 0;
+        std::size_t refresh_count = 0;
+    };
+
+    /**
+     * A tag type to request the seqlock-backed `concurrent` specialization for `NonConcurrentType`, 
+     * eg. `concurrent<seqlocked<stats>>`.
+     * 
+     * @tparam NonConcurrentType A trivially copyable type to wrap
+     */
+    template<typename NonConcurrentType>
+    struct seqlocked;
+
+    /**
+     * A tag type to request the lock-free atomic `concurrent` specialization for `NonConcurrentType`, 
+     * eg. `concurrent<lock_free<std::uint64_t>>`.
+     * 
+     * @tparam NonConcurrentType A type `std::atomic` is always lock-free for
+     */
+    template<typename NonConcurrentType>
+    struct lock_free;
+
+    namespace detail {
+        template<typename NonConcurrentType>
+        struct seqlock_value { using type = NonConcurrentType; };
+
+        template<typename NonConcurrentType>
+        struct seqlock_value<seqlocked<NonConcurrentType>> { using type = NonConcurrentType; };
+
+        template<typename NonConcurrentType>
+        inline constexpr bool is_seqlocked_v = false;
+
+        template<typename NonConcurrentType>
+        inline constexpr bool is_seqlocked_v<seqlocked<NonConcurrentType>> = true;
+
+        template<typename NonConcurrentType>
+        inline constexpr bool is_lock_free_v = false;
+
+        template<typename NonConcurrentType>
+        inline constexpr bool is_lock_free_v<lock_free<NonConcurrentType>> = true;
+
+        template<typename NonConcurrentType>
+        struct lock_free_value { using type = NonConcurrentType; };
+
+        template<typename NonConcurrentType>
+        struct lock_free_value<lock_free<NonConcurrentType>> { using type = NonConcurrentType; };
+
+        /**
+         * True for tag types which select a `concurrent` specialization (eg. `seqlocked<T>`).
+         */
+        template<typename NonConcurrentType>
+        inline constexpr bool is_storage_tag_v = is_seqlocked_v<NonConcurrentType> || is_lock_free_v<NonConcurrentType>;
+    }
+
+    namespace detail {
+        template<typename NonConcurrentType>
+        inline constexpr bool is_always_lock_free_v = false;
+
+        template<typename NonConcurrentType>
+        requires (std::is_trivially_copyable_v<NonConcurrentType> && !std::is_const_v<NonConcurrentType> && !std::is_volatile_v<NonConcurrentType>
+            && std::is_copy_constructible_v<NonConcurrentType> && std::is_move_constructible_v<NonConcurrentType>
+            && std::is_copy_assignable_v<NonConcurrentType> && std::is_move_assignable_v<NonConcurrentType>)
+        inline constexpr bool is_always_lock_free_v<NonConcurrentType> = std::atomic<NonConcurrentType>::is_always_lock_free;
+    }
+
+    /**
+     * Checks whether given type T should be wrapped by the atomic `concurrent` specialization.
+     * 
+     * @tparam T Type to check
+     */
+    template<typename T>
+    concept atomic_storage = detail::is_lock_free_v<T>;
+
+    /**
+     * Lock-free specialization of `concurrent`, selected via `concurrent<lock_free<T>>` for types which fit 
+     * a lock-free `std::atomic`. There is no lock in the object at all; the resource is a single `std::atomic<T>`.
+     * 
+     * `read_access_handle()` hands out a snapshot. There is no write accessor, since a write could not be
+     * committed atomically on its destruction without dropping concurrent writes; modify the resource via 
+     * `write(fn)` (which retries `fn` until its compare-and-swap succeeds), or the `std::atomic` operations.
+     * 
+     * @tparam NonConcurrentType `lock_free<T>`, where T is a type `std::atomic` is always lock-free for
+     * @tparam LockableType Unused
+     * @tparam SharedLockType Unused
+     * @tparam ExclusiveLockType Unused
+     */
+    template<typename NonConcurrentType, basic_shared_lockable LockableType, 
+        template <typename...> typename SharedLockType, 
+        template <typename...> typename ExclusiveLockType >
+    requires atomic_storage<NonConcurrentType>
+    class concurrent<NonConcurrentType, LockableType, SharedLockType, ExclusiveLockType> {
+    public:
+        using value_type = typename detail::lock_free_value<NonConcurrentType>::type;
+        using shared_accessor_t = snapshot_accessor<value_type>;
+
+        static_assert(detail::is_always_lock_free_v<value_type>, "lock_free<T> requires a type std::atomic is always lock-free for.");
+
+        /**
+         * @brief Default constructor
+         * 
+         * Value-initializes the wrapped resource.
+         */
+        concurrent() noexcept : value(value_type{}) {}
+
+        /**
+         * @brief Copy constructor (from wrapped type)
+         */
+        explicit concurrent(value_type initial) noexcept : value(initial) {}
+
+        /**
+         * @brief Get a read-only snapshot of the wrapped object.
+         * 
+         * @return shared_accessor_t Accessor object owning the snapshot
+         */
+        shared_accessor_t read_access_handle() const noexcept { return shared_accessor_t{ load() }; }
+
+        /**
+         * @brief Invoke `fn` with a snapshot of the wrapped object.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, const value_type &>
+        std::invoke_result_t<Fn, const value_type &> read(Fn && fn) const {
+            const auto snapshot = load();
+            return std::invoke(std::forward<Fn>(fn), snapshot);
+        }
+
+        /**
+         * @brief Invoke `fn` with a copy of the wrapped object, then commit the copy via compare-and-swap.
+         * If another write was committed in between, `fn` is invoked again with a fresh copy, until the 
+         * commit succeeds.
+         * 
+         * @note `fn` may be invoked several times, so it should have no side effects besides modifying the copy.
+         * 
+         * @return The result of the last invocation of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, value_type &>
+        std::invoke_result_t<Fn, value_type &> write(Fn && fn) {
+            auto expected = load();
+            for(;;) {
+                auto desired = expected;
+                if constexpr (std::is_void_v<std::invoke_result_t<Fn, value_type &>>) {
+                    std::invoke(fn, desired);
+                    if(value.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        return;
+                    }
+                } else {
+                    decltype(auto) result = std::invoke(fn, desired);
+                    if(value.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        return std::forward<std::invoke_result_t<Fn, value_type &>>(result);
+                    }
+                }
+            }
+        }
+
+        value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept { return value.load(order); }
+        void store(value_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept { value.store(desired, order); }
+        value_type exchange(value_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept { return value.exchange(desired, order); }
+        value_type take(std::memory_order order = std::memory_order_seq_cst) noexcept { return value.exchange(value_type{}, order); }
+
+        bool compare_exchange_weak(value_type & expected, value_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return value.compare_exchange_weak(expected, desired, order);
+        }
+
+        bool compare_exchange_strong(value_type & expected, value_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+            return value.compare_exchange_strong(expected, desired, order);
+        }
+
+        template<typename Operand>
+        value_type fetch_add(Operand operand, std::memory_order order = std::memory_order_seq_cst) noexcept 
+            requires requires (std::atomic<value_type> & a) { a.fetch_add(operand, order); } { return value.fetch_add(operand, order); }
+
+        template<typename Operand>
+        value_type fetch_sub(Operand operand, std::memory_order order = std::memory_order_seq_cst) noexcept 
+            requires requires (std::atomic<value_type> & a) { a.fetch_sub(operand, order); } { return value.fetch_sub(operand, order); }
+
+        value_type fetch_and(value_type operand, std::memory_order order = std::memory_order_seq_cst) noexcept 
+            requires requires (std::atomic<value_type> & a) { a.fetch_and(operand, order); } { return value.fetch_and(operand, order); }
+
+        value_type fetch_or(value_type operand, std::memory_order order = std::memory_order_seq_cst) noexcept 
+            requires requires (std::atomic<value_type> & a) { a.fetch_or(operand, order); } { return value.fetch_or(operand, order); }
+
+        value_type fetch_xor(value_type operand, std::memory_order order = std::memory_order_seq_cst) noexcept 
+            requires requires (std::atomic<value_type> & a) { a.fetch_xor(operand, order); } { return value.fetch_xor(operand, order); }
+
+    private:
+        std::atomic<value_type> value;
+    };
+
+    /**
+     * Checks whether given type T should be wrapped by the seqlock-backed `concurrent` specialization.
+     * 
+     * @tparam T Type to check
+     */
+    template<typename T>
+    concept seqlock_storage = detail::is_seqlocked_v<T>;
+
+    /**
+     * Seqlock-backed specialization of `concurrent` for trivially copyable types, selected via `concurrent<seqlocked<T>>`.
+     * 
+     * Readers never write to shared memory; `read_access_handle()` takes an optimistic copy of the 
+     * resource and retries until the copy is known to be consistent (no writer intervened), then hands 
+     * it out through a `snapshot_accessor`. Writers are serialized via `ExclusiveLockType` on a 
+     * `versioned<LockableType>`, which bumps the sequence counter around the exclusive section.
+     * 
+     * Best suited for resources which are read very frequently and written rarely, since readers
+     * spin while a writer is active.
+     * 
+     * @tparam NonConcurrentType `seqlocked<T>`, where T is a trivially copyable type to wrap
+     * @tparam LockableType A type which satisfies the `BasicSharedLockable` named requirement (eg. std::shared_mutex)
+     * @tparam SharedLockType Unused, readers do not lock
+     * @tparam ExclusiveLockType A RAII type which will be used to lock the `Lockable` when write access is requested (eg. std::unique_lock)
+     */
+    template<typename NonConcurrentType, basic_shared_lockable LockableType, 
+        template <typename...> typename SharedLockType, 
+        template <typename...> typename ExclusiveLockType >
+    requires seqlock_storage<NonConcurrentType>
+    class concurrent<NonConcurrentType, LockableType, SharedLockType, ExclusiveLockType> {
+    public:
+        using value_type = typename detail::seqlock_value<NonConcurrentType>::type;
+        using shared_accessor_t = snapshot_accessor<value_type>;
+        using exclusive_accessor_t = exclusive_accessor<value_type, versioned<LockableType>, ExclusiveLockType>;
+
+        static_assert(std::is_trivially_copyable_v<value_type>, "seqlock-backed concurrent requires a trivially copyable type.");
+
+        /**
+         * @brief Default constructor
+         * 
+         * Value-initializes the wrapped resource.
+         */
+        concurrent() noexcept 
+            requires (std::is_default_constructible_v<value_type>)
+            : resource{}    
+        {}
+
+        /**
+         * @brief Copy constructor (from wrapped type)
+         */
+        explicit concurrent(const value_type& value) noexcept
+            : resource(value)    
+        {}
+
+        /**
+         * @brief Get a consistent, read-only snapshot of the wrapped object. Never locks, and never 
+         * writes to memory shared with other threads.
+         * 
+         * @return shared_accessor_t Accessor object owning the snapshot
+         */
+        shared_accessor_t read_access_handle() const noexcept { return shared_accessor_t{ snapshot() }; }
+
+        /**
+         * @brief Get write (exclusive) access to underlying wrapped object. Concurrent readers will 
+         * retry until the returned accessor object is destroyed.
+         * 
+         * @return exclusive_accessor_t Read & write (exclusive) accessor object to the wrapped object 
+         */
+        decltype(auto) write_access_handle() noexcept { return exclusive_accessor_t{ lockable, resource }; }
+
+        /**
+         * @brief Invoke `fn` with read-only access to the wrapped object, which is a consistent snapshot (see `snapshot()`);
+         * no lock is taken at all.
+         * 
+         * @note The result is returned as is; do not return references into the resource.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, const value_type &>
+        std::invoke_result_t<Fn, const value_type &> read(Fn && fn) const {
+            auto accessor = read_access_handle();
+            return std::invoke(std::forward<Fn>(fn), *accessor);
+        }
+
+        /**
+         * @brief Invoke `fn` with read & write access to the wrapped object, under an exclusive lock.
+         * The lock is held for the duration of the call only, which keeps the critical section minimal.
+         * 
+         * @note The result is returned as is; do not return references into the resource.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, value_type &>
+        std::invoke_result_t<Fn, value_type &> write(Fn && fn) {
+            auto accessor = write_access_handle();
+            return std::invoke(std::forward<Fn>(fn), *accessor);
+        }
+
+        /**
+         * @brief Try to get write (exclusive) access to underlying wrapped object, without blocking.
+         * 
+         * @return std::optional<exclusive_accessor_t> Read & write (exclusive) accessor object, or std::nullopt
+         * if the exclusive lock could not be acquired immediately
+         */
+        std::optional<exclusive_accessor_t> try_write_access_handle() requires mkg::lockable<LockableType> {
+            return lockable.try_lock() ? std::optional<exclusive_accessor_t>{ adopt_exclusive() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get write (exclusive) access to underlying wrapped object, blocking for at most `duration`.
+         * 
+         * @return std::optional<exclusive_accessor_t> Read & write (exclusive) accessor object, or std::nullopt on timeout
+         */
+        template<typename Rep, typename Period>
+        std::optional<exclusive_accessor_t> try_write_access_handle_for(const std::chrono::duration<Rep, Period> & duration) 
+            requires timed_lockable<LockableType> {
+            return lockable.try_lock_for(duration) ? std::optional<exclusive_accessor_t>{ adopt_exclusive() } : std::nullopt;
+        }
+
+        /**
+         * @brief Try to get write (exclusive) access to underlying wrapped object, blocking until `time_point` at most.
+         * 
+         * @return std::optional<exclusive_accessor_t> Read & write (exclusive) accessor object, or std::nullopt on timeout
+         */
+        template<typename Clock, typename Duration>
+        std::optional<exclusive_accessor_t> try_write_access_handle_until(const std::chrono::time_point<Clock, Duration> & time_point) 
+            requires timed_lockable<LockableType> {
+            return lockable.try_lock_until(time_point) ? std::optional<exclusive_accessor_t>{ adopt_exclusive() } : std::nullopt;
+        }
+
+        /**
+         * @brief Replace the wrapped object with `replacement`.
+         * 
+         * @return value_type The previous object
+         */
+        value_type exchange(const value_type & replacement) noexcept {
+            auto accessor = write_access_handle();
+            const auto previous = *accessor;
+            *accessor = replacement;
+            return previous;
+        }
+
+        /**
+         * @brief Replace the wrapped object with a value-initialized one.
+         * 
+         * @return value_type The previous object
+         */
+        value_type take() noexcept requires (std::is_default_constructible_v<value_type>) { return exchange(value_type{}); }
+
+        /**
+         * @brief Take a consistent copy of the wrapped object.
+         * 
+         * @return value_type Copy of the wrapped object
+         */
+        value_type snapshot() const noexcept {
+            alignas(value_type) std::array<unsigned char, sizeof(value_type)> copy;
+            for(;;) {
+                const auto before = lockable.version();
+                if(before & 1) {
+                    // A writer is active, no use in copying.
+                    detail::cpu_relax();
+                    continue;
+                }
+                // This read races with writers by design; torn copies are detected and discarded below.
+                std::memcpy(copy.data(), std::addressof(resource), sizeof(value_type));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(lockable.version() == before) {
+                    return std::bit_cast<value_type>(copy);
+                }
+            }
+        }
+
+        /**
+         * @brief Current version of the seqlock; odd while a writer is active (see `versioned`).
+         */
+        std::uint64_t version() const noexcept { return lockable.version(); }
+
+        /**
+         * @brief Invoke `callback` with the `lock_metrics` of this resource's lock. Only available
+         * when `LockableType` is instrumented (see `instrumented`).
+         */
+        template<typename Callback>
+        void export_metrics(Callback && callback) const requires instrumented_lockable<LockableType> {
+            std::forward<Callback>(callback)(lockable.metrics());
+        }
+
+    private:
+        friend struct detail::concurrent_access;
+
+        /**
+         * @brief Wrap the (already acquired) exclusive lock into an accessor.
+         */
+        exclusive_accessor_t adopt_exclusive() {
+            return exclusive_accessor_t{ ExclusiveLockType<versioned<LockableType>>{ lockable, lock_traits<ExclusiveLockType>::adopt_lock }, resource };
+        }
+
+        value_type resource;
+        mutable versioned<LockableType> lockable; 
+    };
+
+    /**
+     * A read-copy-update (RCU) domain, which tracks readers of RCU protected data through per-thread
+     * striped reader counters, so that writers can wait until no reader may still observe a retired 
+     * version of the data (a grace period).
+     * 
+     * Entering and leaving a read-side critical section never blocks; it only modifies the counter 
+     * of the calling thread's stripe. Each stripe lives on its own cache line.
+     * 
+     * @tparam StripeCount Amount of reader counter stripes
+     */
+    template<std::size_t StripeCount = 32>
+    class rcu_domain : private noncopyable {
+    public:
+        /**
+         * @brief Identifies the reader counter modified by `read_lock()`
+         */
+        struct token {
+            std::size_t stripe;
+            std::size_t parity;
+        };
+
+        /**
+         * @brief Enter a read-side critical section. Wait-free unless a grace period starts 
+         * in between, in which case it is retried.
+         */
+        token read_lock() noexcept {
+            const auto stripe = detail::this_thread_index() % StripeCount;
+            for(;;) {
+                const auto epoch = current_epoch.load();
+                stripes[stripe].readers[epoch & 1].fetch_add(1);
+                // Re-validate, so `synchronize()` of the observed epoch is guaranteed to see our increment.
+                if(current_epoch.load() == epoch) {
+                    return token{ stripe, epoch & 1 };
+                }
+                stripes[stripe].readers[epoch & 1].fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        /**
+         * @brief Leave the read-side critical section entered by `read_lock()`.
+         */
+        void read_unlock(token t) noexcept {
+            stripes[t.stripe].readers[t.parity].fetch_sub(1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Wait until all read-side critical sections which were entered before this call 
+         * have been left. Data unpublished before calling `synchronize()` can be reclaimed afterwards.
+         * 
+         * @note Must not be called from inside a read-side critical section.
+         */
+        void synchronize() {
+            // Grace periods must not overlap, otherwise a reader of the previous epoch might be missed.
+            std::lock_guard<std::mutex> guard{ grace_period_mutex };
+            if(pending) {
+                wait_for_readers(pending_parity);
+                pending = false;
+            }
+            wait_for_readers(current_epoch.fetch_add(1) & 1);
+        }
+
+        /**
+         * @brief Non-blocking variant of `synchronize()`: starts a grace period unless one is pending, and 
+         * returns true once it is over. Data unpublished before the call which started the grace period 
+         * (the first call after one which returned true) can be reclaimed once a call returns true.
+         * 
+         * @note Must not be called from inside a read-side critical section.
+         */
+        bool try_synchronize() {
+            std::unique_lock<std::mutex> guard{ grace_period_mutex, std::try_to_lock };
+            if(!guard.owns_lock()) {
+                return false;
+            }
+            if(!pending) {
+                pending_parity = current_epoch.fetch_add(1) & 1;
+                pending = true;
+            }
+            for(auto & stripe : stripes) {
+                if(stripe.readers[pending_parity].load() != 0) {
+                    return false;
+                }
+            }
+            pending = false;
+            return true;
+        }
+
+    private:
+        void wait_for_readers(std::size_t parity) noexcept {
+            for(auto & stripe : stripes) {
+                for(std::size_t spins = 0; stripe.readers[parity].load() != 0; ++spins) {
+                    if(spins < 64) {
+                        detail::cpu_relax();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+
+        struct alignas(cache_line_size) stripe {
+            std::atomic<std::size_t> readers[2] = {};
+        };
+
+        std::atomic<std::size_t> current_epoch = {0};
+        std::array<stripe, StripeCount> stripes;
+        std::mutex grace_period_mutex;
+        /// Whether a grace period started by `try_synchronize()` is not over yet (guarded by `grace_period_mutex`)
+        bool pending = false;
+        std::size_t pending_parity = 0;
+    };
+
+    /**
+     * A tag type to request the read-copy-update (copy-on-write) `concurrent` specialization for 
+     * `NonConcurrentType`, eg. `concurrent<rcu<route_table>>`.
+     * 
+     * @tparam NonConcurrentType A copy-constructible type to wrap
+     */
+    template<typename NonConcurrentType>
+    struct rcu;
+
+    namespace detail {
+        template<typename NonConcurrentType>
+        inline constexpr bool is_rcu_v = false;
+
+        template<typename NonConcurrentType>
+        inline constexpr bool is_rcu_v<rcu<NonConcurrentType>> = true;
+
+        template<typename NonConcurrentType>
+        inline constexpr bool is_storage_tag_v<rcu<NonConcurrentType>> = true;
+    }
+
+    /**
+     * A read accessor to an RCU protected resource. Holds a read-side critical section of the 
+     * resource's `rcu_domain`, so the observed (immutable) version of the resource is kept alive 
+     * until the accessor is destroyed. Never blocks.
+     * 
+     * @tparam NonConcurrentType Type of the protected resource
+     * @tparam DomainType Type of the `rcu_domain` protecting the resource
+     */
+    template<typename NonConcurrentType, typename DomainType>
+    class rcu_read_accessor : private noncopyable {
+    public:
+        /**
+         * @brief Enters a read-side critical section of `domain`, then observes `published`.
+         */
+        explicit rcu_read_accessor(DomainType & domain, const std::atomic<const NonConcurrentType*> & published) noexcept
+            : domain(&domain), critical_section(domain.read_lock()), locked_resource(published.load())
+        {}
+
+        rcu_read_accessor(rcu_read_accessor && other) noexcept
+            : domain(std::exchange(other.domain, nullptr)), critical_section(other.critical_section), locked_resource(other.locked_resource)
+        {}
+
+        ~rcu_read_accessor() {
+            if(domain) {
+                domain->read_unlock(critical_section);
+            }
+        }
+
+        /**
+         * @brief Class member access operator overload to behave as if
+         * instance of `rcu_read_accessor` class is a pointer to the observed version.
+         */
+        inline const NonConcurrentType * operator->() const noexcept { return locked_resource; }
+
+        /**
+         * Dereference (star) operator overload
+         * 
+         * @return const reference to the observed version of the resource
+         */
+        inline const NonConcurrentType & operator*() const noexcept { return *locked_resource; }
+    private:
+        DomainType * domain;
+        typename DomainType::token critical_section;
+        const NonConcurrentType * locked_resource;
+    };
+
+    /**
+     * A transactional write accessor to an RCU protected resource. Writers are serialized by locking
+     * `LockableType` via `LockType`. The accessor works on a private copy (draft) of the current version,
+     * which is published atomically when the accessor is destroyed. The previous version is reclaimed
+     * after all readers which might still observe it are gone.
+     * 
+     * The draft is discarded instead, if `discard()` is called or an exception leaves the accessor's scope.
+     * 
+     * @tparam NonConcurrentType Type of the protected resource
+     * @tparam LockableType Type of the `Lockable` object
+     * @tparam LockType Type of the `Lock` object to lock the `Lockable` type
+     * @tparam DomainType Type of the `rcu_domain` protecting the resource
+     */
+    template<typename NonConcurrentType, typename LockableType, template <typename...> typename LockType, typename DomainType>
+    class rcu_write_accessor : private noncopyable {
+    public:
+        /**
+         * @brief Locks `lockable`, then takes a draft copy of the version published in `published`.
+         */
+        explicit rcu_write_accessor(LockableType & lockable, DomainType & domain, std::atomic<const NonConcurrentType*> & published)
+            : lock(lockable), domain(domain), published(published), 
+              draft(std::make_unique<NonConcurrentType>(*published.load(std::memory_order_relaxed))),
+              exceptions_on_entry(std::uncaught_exceptions())
+        {}
+
+        ~rcu_write_accessor() {
+            if(draft && std::uncaught_exceptions() == exceptions_on_entry) {
+                const auto * retired = published.exchange(draft.release());
+                domain.synchronize();
+                delete retired;
+            }
+        }
+
+        /**
+         * @brief Drop the draft; the published version will not be replaced.
+         */
+        void discard() noexcept { draft.reset(); }
+
+        /**
+         * @brief Class member access operator overload to behave as if
+         * instance of `rcu_write_accessor` class is a pointer to the draft.
+         */
+        inline NonConcurrentType * operator->() noexcept { return draft.get(); }
+
+        /**
+         * Dereference (star) operator overload
+         * 
+         * @return reference to the draft
+         */
+        inline NonConcurrentType & operator*() noexcept { return *draft; }
+    private:
+        LockType<LockableType> lock;
+        DomainType & domain;
+        std::atomic<const NonConcurrentType*> & published;
+        std::unique_ptr<NonConcurrentType> draft;
+        int exceptions_on_entry;
+    };
+
+    /**
+     * Read-copy-update (copy-on-write) specialization of `concurrent`, selected via `concurrent<rcu<T>>`.
+     * 
+     * Readers never block and never touch a lock; `read_access_handle()` observes the currently 
+     * published immutable version. Writers are serialized via `ExclusiveLockType`; `write_access_handle()`
+     * clones the current version, and publishes the modified clone when the accessor is destroyed.
+     * 
+     * Best suited for resources which are read on every request and rebuilt rarely, since each write
+     * copies the whole resource and waits for a grace period.
+     * 
+     * @tparam NonConcurrentType `rcu<T>`, where T is a copy-constructible type to wrap
+     * @tparam LockableType A type which satisfies the `BasicSharedLockable` named requirement (eg. std::shared_mutex)
+     * @tparam SharedLockType Unused, readers do not lock
+     * @tparam ExclusiveLockType A RAII type which will be used to lock the `Lockable` when write access is requested (eg. std::unique_lock)
+     */
+    template<typename NonConcurrentType, basic_shared_lockable LockableType, 
+        template <typename...> typename SharedLockType, 
+        template <typename...> typename ExclusiveLockType >
+    requires detail::is_rcu_v<NonConcurrentType>
+    class concurrent<NonConcurrentType, LockableType, SharedLockType, ExclusiveLockType> {
+        template<typename T> struct unwrap;
+        template<typename T> struct unwrap<rcu<T>> { using type = T; };
+    public:
+        using value_type = typename unwrap<NonConcurrentType>::type;
+        using domain_t = rcu_domain<>;
+        using shared_accessor_t = rcu_read_accessor<value_type, domain_t>;
+        using exclusive_accessor_t = rcu_write_accessor<value_type, LockableType, ExclusiveLockType, domain_t>;
+
+        static_assert(std::is_copy_constructible_v<value_type>, "rcu-backed concurrent requires a copy-constructible type.");
+
+        /**
+         * @brief Default constructor
+         * 
+         * Publishes a default constructed `value_type`.
+         */
+        concurrent() requires (std::is_default_constructible_v<value_type>)
+            : published(new value_type{})
+        {}
+
+        /**
+         * @brief Copy constructor (from wrapped type)
+         * 
+         * Publishes a copy of `value`.
+         */
+        explicit concurrent(const value_type& value)
+            : published(new value_type(value))
+        {}
+
+        /**
+         * @brief Move constructor (from wrapped type)
+         * 
+         * Publishes `value`, moved into the resource.
+         */
+        explicit concurrent(value_type&& value) requires (std::is_move_constructible_v<value_type>)
+            : published(new value_type(std::move(value)))
+        {}
+
+        /**
+         * @brief Destructor
+         * 
+         * @note No accessors may outlive the resource.
+         */
+        ~concurrent() { delete published.load(); }
+
+        /**
+         * @brief Get read-only access to the currently published version of the wrapped object. 
+         * Never blocks; writers publishing a new version in the meantime do not affect the accessor.
+         * 
+         * @return shared_accessor_t Read-only accessor object to the observed version
+         */
+        shared_accessor_t read_access_handle() const noexcept { return shared_accessor_t{ domain, published }; }
+
+        /**
+         * @brief Get transactional write access to a draft copy of the wrapped object. Other writers 
+         * are excluded until the returned accessor object is destroyed, at which point the draft is 
+         * published.
+         * 
+         * @return exclusive_accessor_t Transactional write accessor object to the draft
+         */
+        exclusive_accessor_t write_access_handle() { return exclusive_accessor_t{ lockable, domain, published }; }
+
+        /**
+         * @brief Publish `replacement`, and move the previous version out once no reader can observe it 
+         * anymore. Unlike `write_access_handle()`, the current version is not copied.
+         * 
+         * @return value_type The previous version
+         */
+        value_type exchange(value_type replacement) requires (std::is_move_constructible_v<value_type>) {
+            auto next = std::make_unique<value_type>(std::move(replacement));
+            std::unique_ptr<const value_type> retired;
+            {
+                ExclusiveLockType<LockableType> lock{ lockable };
+                retired.reset(published.exchange(next.release()));
+            }
+            domain.synchronize();
+            // Versions are created mutable, and nobody else can reach this one anymore.
+            return std::move(*const_cast<value_type *>(retired.get()));
+        }
+
+        /**
+         * @brief Publish a default constructed version, and move the previous one out (see `exchange()`).
+         * 
+         * @return value_type The previous version
+         */
+        value_type take() requires (std::is_default_constructible_v<value_type> && std::is_move_constructible_v<value_type>) { 
+            return exchange(value_type{}); 
+        }
+
+        /**
+         * @brief Invoke `fn` with read-only access to the wrapped object, which is the currently published version.
+         * Never blocks.
+         * 
+         * @note The result is returned as is; do not return references into the resource.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, const value_type &>
+        std::invoke_result_t<Fn, const value_type &> read(Fn && fn) const {
+            auto accessor = read_access_handle();
+            return std::invoke(std::forward<Fn>(fn), *accessor);
+        }
+
+        /**
+         * @brief Invoke `fn` with read & write access to the wrapped object, which is a draft copy of the current version.
+         * The draft is published when `fn` returns, and discarded if `fn` throws.
+         * 
+         * @note The result is returned as is; do not return references into the resource.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        requires std::invocable<Fn, value_type &>
+        std::invoke_result_t<Fn, value_type &> write(Fn && fn) {
+            auto accessor = write_access_handle();
+            return std::invoke(std::forward<Fn>(fn), *accessor);
+        }
+
+        /**
+         * @brief Invoke `callback` with the `lock_metrics` of this resource's lock. Only available
+         * when `LockableType` is instrumented (see `instrumented`).
+         */
+        template<typename Callback>
+        void export_metrics(Callback && callback) const requires instrumented_lockable<LockableType> {
+            std::forward<Callback>(callback)(lockable.metrics());
+        }
+
+    private:
+        std::atomic<const value_type*> published;
+        mutable domain_t domain;
+        mutable LockableType lockable; 
+    };
+
+    /**
+     * A request for read-only (shared) access to a `concurrent` resource, to be passed to `lock_all`.
+     * 
+     * @tparam ConcurrentType Type of the requested `concurrent` resource
+     */
+    template<typename ConcurrentType>
+    class shared_access_request {
+    public:
+        using accessor_t = typename ConcurrentType::shared_accessor_t;
+
+        explicit shared_access_request(const ConcurrentType & resource, const std::source_location & site = std::source_location::current()) noexcept 
+            : resource(resource), site(site) {}
+
+        const void * address() const noexcept { return std::addressof(detail::concurrent_access::lockable(resource)); }
+        std::size_t rank() const noexcept { return detail::lock_order_rank(detail::concurrent_access::lockable(resource)); }
+
+        void lock() const { 
+            auto & lockable = detail::concurrent_access::lockable(resource);
+            detail::announce_acquisition(lockable, site);
+            lockable.lock_shared(); 
+        }
+
+        void unlock() const { detail::concurrent_access::lockable(resource).unlock_shared(); }
+        accessor_t adopt() const { return detail::concurrent_access::adopt_shared(resource); }
+    private:
+        const ConcurrentType & resource;
+        /// Call site of the `lock_all` / `apply` call, which is announced to `ranked_lockable` locks
+        std::source_location site;
+    };
+
+    /**
+     * A request for read & write (exclusive) access to a `concurrent` resource, to be passed to `lock_all`.
+     * 
+     * @tparam ConcurrentType Type of the requested `concurrent` resource
+     */
+    template<typename ConcurrentType>
+    class exclusive_access_request {
+    public:
+        using accessor_t = typename ConcurrentType::exclusive_accessor_t;
+
+        explicit exclusive_access_request(ConcurrentType & resource, const std::source_location & site = std::source_location::current()) noexcept 
+            : resource(resource), site(site) {}
+
+        const void * address() const noexcept { return std::addressof(detail::concurrent_access::lockable(resource)); }
+        std::size_t rank() const noexcept { return detail::lock_order_rank(detail::concurrent_access::lockable(resource)); }
+
+        void lock() const { 
+            auto & lockable = detail::concurrent_access::lockable(resource);
+            detail::announce_acquisition(lockable, site);
+            lockable.lock(); 
+        }
+
+        void unlock() const { detail::concurrent_access::lockable(resource).unlock(); }
+        accessor_t adopt() const { return detail::concurrent_access::adopt_exclusive(resource); }
+    private:
+        ConcurrentType & resource;
+        /// Call site of the `lock_all` / `apply` call, which is announced to `ranked_lockable` locks
+        std::source_location site;
+    };
+
+    /**
+     * @brief Request read-only (shared) access to `resource` in a `lock_all` call.
+     */
+    template<typename ConcurrentType>
+    shared_access_request<ConcurrentType> shared_access(const ConcurrentType & resource, const std::source_location & site = std::source_location::current()) noexcept { 
+        return shared_access_request<ConcurrentType>{ resource, site }; 
+    }
+
+    /**
+     * @brief Request read & write (exclusive) access to `resource` in a `lock_all` call.
+     */
+    template<typename ConcurrentType>
+    exclusive_access_request<ConcurrentType> exclusive_access(ConcurrentType & resource, const std::source_location & site = std::source_location::current()) noexcept { 
+        return exclusive_access_request<ConcurrentType>{ resource, site }; 
+    }
+
+    /**
+     * @brief Atomically acquire a mixed set of shared and exclusive accessors to several `concurrent` resources,
+     * without risking a deadlock against other `lock_all` calls. Locks are always acquired in the order of 
+     * their ranks (see `ranked`; unranked locks come last), then of their addresses, and if acquiring any of 
+     * them throws, the ones already acquired are released. Each acquisition is announced to `ranked_lockable`
+     * locks with the call site of its request (ie. of the `lock_all` / `apply` call expression).
+     * 
+     * ~~~cpp
+     * auto [index_writer, reverse_writer, config_reader] = 
+     *     mkg::lock_all(mkg::exclusive_access(index), mkg::exclusive_access(reverse_index), mkg::shared_access(config));
+     * ~~~
+     * 
+     * @note Each resource may be requested only once, and none of them may already be locked by the caller.
+     * 
+     * @param requests Access requests, created via `shared_access` and `exclusive_access`
+     * @return std::tuple of the requested accessors, in the order of `requests`
+     */
+    template<typename... Requests>
+    requires (sizeof...(Requests) > 0)
+    std::tuple<typename Requests::accessor_t...> lock_all(const Requests &... requests) {
+        struct lock_step {
+            std::size_t rank;
+            const void * address;
+            const void * request;
+            void (*lock)(const void *);
+            void (*unlock)(const void *);
+        };
+
+        std::array<lock_step, sizeof...(Requests)> steps = { lock_step{ 
+            requests.rank(), requests.address(), std::addressof(requests),
+            [](const void * request) { static_cast<const Requests *>(request)->lock(); },
+            [](const void * request) { static_cast<const Requests *>(request)->unlock(); }
+        }... };
+
+        // The same order `ranked` checks against: increasing rank, then increasing address.
+        std::sort(steps.begin(), steps.end(), [](const lock_step & lhs, const lock_step & rhs) { 
+            if(lhs.rank != rhs.rank) {
+                return lhs.rank < rhs.rank;
+            }
+            return std::less<const void *>{}(lhs.address, rhs.address); 
+        });
+        assert(std::adjacent_find(steps.begin(), steps.end(), [](const lock_step & lhs, const lock_step & rhs) { 
+            return lhs.address == rhs.address; 
+        }) == steps.end() && "lock_all: each resource may be requested only once");
+
+        std::size_t locked = 0;
+        try {
+            for(; locked < steps.size(); ++locked) {
+                steps[locked].lock(steps[locked].request);
+            }
+        } catch(...) {
+            while(locked > 0) {
+                --locked;
+                steps[locked].unlock(steps[locked].request);
+            }
+            throw;
+        }
+        return std::tuple<typename Requests::accessor_t...>{ requests.adopt()... };
+    }
+
+    /**
+     * @brief Invoke `fn` with access to several `concurrent` resources at once, under the locks acquired by 
+     * `lock_all(requests...)`. The locks are released as soon as `fn` returns.
+     * 
+     * ~~~cpp
+     * const auto moved = mkg::apply([](auto & from, auto & to, const auto & limits) { 
+     *     return transfer(from, to, limits); 
+     * }, mkg::exclusive_access(source), mkg::exclusive_access(target), mkg::shared_access(config));
+     * ~~~
+     * 
+     * @param fn Callable, invoked with a (const-qualified, for shared requests) reference to each resource, in the order of `requests`
+     * @param requests Access requests, created via `shared_access` and `exclusive_access`
+     * @return The result of `fn`
+     */
+    template<typename Fn, typename... Requests>
+    requires (sizeof...(Requests) > 0)
+    decltype(auto) apply(Fn && fn, const Requests &... requests) {
+        auto accessors = lock_all(requests...);
+        return std::apply([&fn](auto &... accessor) -> decltype(auto) { 
+            return std::invoke(std::forward<Fn>(fn), *accessor...); 
+        }, accessors);
+    }
+
+    /**
+     * A wrapper type to protect an associative `NonConcurrentType` (eg. std::map, std::unordered_map) by 
+     * splitting it into `ShardCount` independently locked `concurrent` shards. Each key is owned by 
+     * exactly one shard, determined by `Hash`, so accessors to keys of different shards do not contend
+     * with each other.
+     * 
+     * Each shard is placed on its own cache line to prevent false sharing between the shards' locks.
+     * 
+     * @tparam NonConcurrentType A non thread-safe associative type to wrap, must expose `key_type`
+     * @tparam ShardCount Amount of shards (and locks) the resource is split into
+     * @tparam Hash A hash function object type for `NonConcurrentType::key_type`
+     * @tparam LockableType A type which satisfies the `BasicSharedLockable` named requirement (eg. std::shared_mutex)
+     * @tparam SharedLockType A RAII type which will be used to lock the `Lockable` when read access is requested (eg. std::shared_lock)
+     * @tparam ExclusiveLockType A RAII type which will be used to lock the `Lockable` when write access is requested (eg. std::unique_lock)
+     */
+    template<typename NonConcurrentType, std::size_t ShardCount, typename Hash, 
+        basic_shared_lockable LockableType, 
+        template <typename...> typename SharedLockType, 
+        template <typename...> typename ExclusiveLockType >
+    class sharded_concurrent {
+        static_assert(ShardCount > 0, "sharded_concurrent requires at least one shard.");
+    public:
+        using key_type = typename NonConcurrentType::key_type;
+        using shard_t = concurrent<NonConcurrentType, LockableType, SharedLockType, ExclusiveLockType>;
+        using shared_accessor_t = typename shard_t::shared_accessor_t;
+        using exclusive_accessor_t = typename shard_t::exclusive_accessor_t;
+
+        /**
+         * @brief Default constructor
+         * 
+         * Instantiates every shard's `NonConcurrentType` by invoking its' default constructor.
+         * 
+         * @exception noexcept if `NonConcurrentType` and `Hash` are `NoThrowDefaultConstructible`
+         */
+        sharded_concurrent()
+            noexcept(std::is_nothrow_default_constructible_v<NonConcurrentType> && std::is_nothrow_default_constructible_v<Hash>)
+            requires (std::is_default_constructible_v<NonConcurrentType> && std::is_default_constructible_v<Hash>)
+            = default;
+
+        /**
+         * @brief Allocator-extended constructor; every shard is constructed with `allocator`.
+         */
+        template<typename Allocator>
+        requires std::uses_allocator_v<NonConcurrentType, Allocator> && (!std::invocable<const Allocator &, std::size_t>)
+        sharded_concurrent(std::allocator_arg_t, const Allocator & allocator)
+            : shards{ make_shards([&allocator](std::size_t) -> const Allocator & { return allocator; }, std::make_index_sequence<ShardCount>{}) }
+        {}
+
+        /**
+         * @brief Allocator-extended constructor; shard `i` is constructed with `make_allocator(i)`, so that each 
+         * shard can allocate from its own arena:
+         * 
+         * ~~~cpp
+         * std::array<mkg::arena, 16> arenas;
+         * mkg::sharded_concurrent<std::pmr::map<int, int>> map{ std::allocator_arg, [&](std::size_t i) { return &arenas[i]; } };
+         * ~~~
+         */
+        template<typename AllocatorFactory>
+        requires std::invocable<AllocatorFactory &, std::size_t> 
+            && std::uses_allocator_v<NonConcurrentType, std::invoke_result_t<AllocatorFactory &, std::size_t>>
+        sharded_concurrent(std::allocator_arg_t, AllocatorFactory make_allocator)
+            : shards{ make_shards(make_allocator, std::make_index_sequence<ShardCount>{}) }
+        {}
+
+        /**
+         * @brief Amount of shards the resource is split into
+         */
+        static constexpr std::size_t shard_count() noexcept { return ShardCount; }
+
+        /**
+         * @brief Index of the shard which owns the `key`
+         * 
+         * The hash value is mixed before being reduced to the shard index, so identity hashes 
+         * (like std::hash of integral types) still spread consecutive keys over the shards.
+         */
+        std::size_t shard_index(const key_type & key) const noexcept(noexcept(std::declval<const Hash&>()(key))) {
+            const auto mixed = static_cast<std::uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>((mixed ^ (mixed >> 32)) % ShardCount);
+        }
+
+        /**
+         * @brief Get read-only (shared) access to the shard which owns the `key`. Only the owning
+         * shard is locked.
+         * 
+         * @return shared_accessor_t Read-only (shared) accessor object to the owning shard
+         */
+        decltype(auto) read_access_handle(const key_type & key, const std::source_location & site = std::source_location::current()) const { 
+            return shards[shard_index(key)].value.read_access_handle(site); 
+        }
+
+        /**
+         * @brief Get write (exclusive) access to the shard which owns the `key`. Only the owning
+         * shard is locked.
+         * 
+         * @return exclusive_accessor_t Read & write (exclusive) accessor object to the owning shard
+         */
+        decltype(auto) write_access_handle(const key_type & key, const std::source_location & site = std::source_location::current()) { 
+            return shards[shard_index(key)].value.write_access_handle(site); 
+        }
+
+        /**
+         * @brief Invoke `fn` with read-only access to the shard which owns the `key`, under the shard's shared lock.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        decltype(auto) read(const key_type & key, Fn && fn) const { return shards[shard_index(key)].value.read(std::forward<Fn>(fn)); }
+
+        /**
+         * @brief Invoke `fn` with read & write access to the shard which owns the `key`, under the shard's exclusive lock.
+         * 
+         * @return The result of `fn`
+         */
+        template<typename Fn>
+        decltype(auto) write(const key_type & key, Fn && fn) { return shards[shard_index(key)].value.write(std::forward<Fn>(fn)); }
+
+        /**
+         * @brief Get read-only (shared) access to all shards at once (eg. for iteration). Shards are
+         * always locked in ascending index order, so concurrent callers cannot deadlock each other.
+         * 
+         * @note Do not call this while holding an accessor to any of the shards from the same thread.
+         * 
+         * @return std::array<shared_accessor_t, ShardCount> Read-only accessors, one for each shard
+         */
+        decltype(auto) read_access_handle_all() const { return read_access_handle_all(std::make_index_sequence<ShardCount>{}); }
+
+        /**
+         * @brief Get write (exclusive) access to all shards at once. Shards are always locked in 
+         * ascending index order, so concurrent callers cannot deadlock each other.
+         * 
+         * @note Do not call this while holding an accessor to any of the shards from the same thread.
+         * 
+         * @return std::array<exclusive_accessor_t, ShardCount> Read & write accessors, one for each shard
+         */
+        decltype(auto) write_access_handle_all() { return write_access_handle_all(std::make_index_sequence<ShardCount>{}); }
+
+    private:
+        struct alignas(cache_line_size) shard {
+            shard_t value;
+        };
+
+        template<typename AllocatorFactory, std::size_t... Indices>
+        static std::array<shard, ShardCount> make_shards(AllocatorFactory && make_allocator, std::index_sequence<Indices...>) {
+            // Shards are neither copyable nor movable; guaranteed copy elision constructs them in place.
+            return { shard{ shard_t{ std::allocator_arg, make_allocator(Indices) } }... };
+        }
+
+        template<std::size_t... Indices>
+        std::array<shared_accessor_t, ShardCount> read_access_handle_all(std::index_sequence<Indices...>) const {
+            // Elements of a braced-init-list are initialized in order, which gives us the lock ordering.
+            return { shards[Indices].value.read_access_handle()... };
+        }
+
+        template<std::size_t... Indices>
+        std::array<exclusive_accessor_t, ShardCount> write_access_handle_all(std::index_sequence<Indices...>) {
+            return { shards[Indices].value.write_access_handle()... };
+        }
+
+        [[no_unique_address]] Hash hasher;
+        std::array<shard, ShardCount> shards;
+    };
+
+    /**
+     * An accessor type which holds several locks at once, along with the resource (or part of it) 
+     * they protect. Handed out by `striped_concurrent`.
+     * 
+     * @tparam Resource Type of the exposed resource; a reference, or a view (eg. std::span) held by value
+     * @tparam LockType Type of the (possibly unowned) locks
+     * @tparam LockCount Amount of locks
+     */
+    template<typename Resource, typename LockType, std::size_t LockCount>
+    class striped_accessor : private noncopyable {
+    public:
+        /**
+         * @brief Striped accessor object constructor
+         * 
+         * @param locks Acquired locks (or unowned ones, for stripes which are not covered)
+         * @param resource Resource to grant access to
+         */
+        constexpr explicit striped_accessor(std::array<LockType, LockCount> && locks, Resource resource)
+            : locks(std::move(locks)), resource(resource)
+        {}
+
+        /**
+         * @brief Class member access operator overload to behave as if
+         * instance of `striped_accessor` class is a pointer to the resource.
+         */
+        inline auto * operator->() noexcept { return std::addressof(resource); }
+
+        /**
+         * Dereference (star) operator overload
+         * 
+         * @return reference to the resource
+         */
+        inline decltype(auto) operator*() noexcept { return (resource); }
+    private:
+        std::array<LockType, LockCount> locks;
+        Resource resource;
+    };
+
+    /**
+     * A wrapper type to protect a contiguous `NonConcurrentType` (eg. std::vector, std::array) with a fixed 
+     * table of `StripeCount` locks, so that threads accessing disjoint elements do not serialize on a single lock.
+     * 
+     * Elements are grouped into blocks of (at least) a cache line, and the blocks are assigned to the stripes
+     * round-robin. Element accessors lock the owning stripe, range accessors lock every stripe the range covers,
+     * and whole-container accessors lock all stripes (so the container may be resized). Stripes are always 
+     * locked in ascending order, so concurrent callers cannot deadlock each other.
+     * 
+     * @note Do not request an accessor while holding another one from the same thread.
+     * 
+     * @tparam NonConcurrentType A non thread-safe contiguous container to wrap
+     * @tparam StripeCount Amount of stripes (and locks)
+     * @tparam LockableType A type which satisfies the `BasicSharedLockable` named requirement (eg. std::shared_mutex)
+     * @tparam SharedLockType A RAII type which will be used to lock the `Lockable` when read access is requested (eg. std::shared_lock)
+     * @tparam ExclusiveLockType A RAII type which will be used to lock the `Lockable` when write access is requested (eg. std::unique_lock)
+     */
+    template<typename NonConcurrentType, std::size_t StripeCount, 
+        basic_shared_lockable LockableType, 
+        template <typename...> typename SharedLockType, 
+        template <typename...> typename ExclusiveLockType >
+    class striped_concurrent {
+        static_assert(StripeCount > 0, "striped_concurrent requires at least one stripe.");
+        static_assert(std::ranges::contiguous_range<NonConcurrentType> && std::ranges::sized_range<NonConcurrentType>,
+            "striped_concurrent requires a contiguous container.");
+    public:
+        using value_type = std::ranges::range_value_t<NonConcurrentType>;
+        using shared_lock_t = SharedLockType<LockableType>;
+        using exclusive_lock_t = ExclusiveLockType<LockableType>;
+        using shared_accessor_t = shared_accessor<value_type, LockableType, SharedLockType>;
+        using exclusive_accessor_t = exclusive_accessor<value_type, LockableType, ExclusiveLockType>;
+        using shared_range_accessor_t = striped_accessor<std::span<const value_type>, shared_lock_t, StripeCount>;
+        using exclusive_range_accessor_t = striped_accessor<std::span<value_type>, exclusive_lock_t, StripeCount>;
+        using shared_all_accessor_t = striped_accessor<const NonConcurrentType &, shared_lock_t, StripeCount>;
+        using exclusive_all_accessor_t = striped_accessor<NonConcurrentType &, exclusive_lock_t, StripeCount>;
+
+        /**
+         * Amount of consecutive elements assigned to the same stripe
+         */
+        static constexpr std::size_t block_size = std::max<std::size_t>(1, cache_line_size / sizeof(value_type));
+
+        /**
+         * @brief Default constructor
+         * 
+         * Instantiates the `NonConcurrentType` by invoking its' default constructor.
+         */
+        striped_concurrent() 
+            noexcept(std::is_nothrow_default_constructible_v<NonConcurrentType>) 
+            requires (std::is_default_constructible_v<NonConcurrentType>)
+            : resource{}
+        {}
+
+        /**
+         * @brief Move constructor (from wrapped type)
+         */
+        explicit striped_concurrent(NonConcurrentType value) 
+            noexcept(std::is_nothrow_move_constructible_v<NonConcurrentType>) 
+            : resource(std::move(value))
+        {}
+
+        /**
+         * @brief Amount of stripes (and locks) the resource is protected by
+         */
+        static constexpr std::size_t stripe_count() noexcept { return StripeCount; }
+
+        /**
+         * @brief Index of the stripe which owns the element at `index`
+         */
+        static constexpr std::size_t stripe_index(std::size_t index) noexcept { return (index / block_size) % StripeCount; }
+
+        /**
+         * @brief Get read-only (shared) access to the element at `index`. Only the owning stripe is locked.
+         * 
+         * @return shared_accessor_t Read-only (shared) accessor object to the element
+         */
+        shared_accessor_t read_access_handle(std::size_t index) const {
+            shared_lock_t lock{ stripes[stripe_index(index)].lockable };
+            return shared_accessor_t{ std::move(lock), element(index) };
+        }
+
+        /**
+         * @brief Get write (exclusive) access to the element at `index`. Only the owning stripe is locked.
+         * 
+         * @return exclusive_accessor_t Read & write (exclusive) accessor object to the element
+         */
+        exclusive_accessor_t write_access_handle(std::size_t index) {
+            exclusive_lock_t lock{ stripes[stripe_index(index)].lockable };
+            return exclusive_accessor_t{ std::move(lock), element(index) };
+        }
+
+        /**
+         * @brief Get read-only (shared) access to `count` elements starting at `offset`, as a std::span. 
+         * Only the stripes owning these elements are locked.
+         * 
+         * @return shared_range_accessor_t Read-only (shared) accessor object to the span
+         */
+        shared_range_accessor_t read_access_handle(std::size_t offset, std::size_t count) const {
+            auto locks = lock_range<shared_lock_t>(offset, count);
+            assert(offset + count <= std::ranges::size(resource) && "striped_concurrent: span out of range");
+            return shared_range_accessor_t{ std::move(locks), std::span<const value_type>{ std::ranges::data(resource) + offset, count } };
+        }
+
+        /**
+         * @brief Get write (exclusive) access to `count` elements starting at `offset`, as a std::span. 
+         * Only the stripes owning these elements are locked.
+         * 
+         * @return exclusive_range_accessor_t Read & write (exclusive) accessor object to the span
+         */
+        exclusive_range_accessor_t write_access_handle(std::size_t offset, std::size_t count) {
+            auto locks = lock_range<exclusive_lock_t>(offset, count);
+            assert(offset + count <= std::ranges::size(resource) && "striped_concurrent: span out of range");
+            return exclusive_range_accessor_t{ std::move(locks), std::span<value_type>{ std::ranges::data(resource) + offset, count } };
+        }
+
+        /**
+         * @brief Get read-only (shared) access to the whole container. Locks all stripes.
+         * 
+         * @return shared_all_accessor_t Read-only (shared) accessor object to the container
+         */
+        shared_all_accessor_t read_access_handle_all() const {
+            return shared_all_accessor_t{ lock_range<shared_lock_t>(0, StripeCount * block_size), resource };
+        }
+
+        /**
+         * @brief Get write (exclusive) access to the whole container, eg. to resize it. Locks all stripes.
+         * 
+         * @return exclusive_all_accessor_t Read & write (exclusive) accessor object to the container
+         */
+        exclusive_all_accessor_t write_access_handle_all() {
+            return exclusive_all_accessor_t{ lock_range<exclusive_lock_t>(0, StripeCount * block_size), resource };
+        }
+
+    private:
+        // The size only changes while all stripes are locked, so holding any of them makes it stable.
+        const value_type & element(std::size_t index) const noexcept {
+            assert(index < std::ranges::size(resource) && "striped_concurrent: index out of range");
+            return std::ranges::data(resource)[index];
+        }
+
+        value_type & element(std::size_t index) noexcept {
+            assert(index < std::ranges::size(resource) && "striped_concurrent: index out of range");
+            return std::ranges::data(resource)[index];
+        }
+
+        /**
+         * @brief Lock the stripes owning the elements [offset, offset + count) in ascending stripe order.
+         */
+        template<typename LockType>
+        std::array<LockType, StripeCount> lock_range(std::size_t offset, std::size_t count) const {
+            std::array<bool, StripeCount> covered = {};
+            if(count > 0) {
+                const auto first_block = offset / block_size, last_block = (offset + count - 1) / block_size;
+                for(auto block = first_block; block <= last_block && block - first_block < StripeCount; ++block) {
+                    covered[block % StripeCount] = true;
+                }
+            }
+            std::array<LockType, StripeCount> locks;
+            for(std::size_t stripe = 0; stripe < StripeCount; ++stripe) {
+                if(covered[stripe]) {
+                    locks[stripe] = LockType{ stripes[stripe].lockable };
+                }
+            }
+            return locks;
+        }
+
+        struct alignas(cache_line_size) stripe {
+            mutable LockableType lockable;
+        };
+
+        NonConcurrentType resource;
+        std::array<stripe, StripeCount> stripes;
+    };
 
 }
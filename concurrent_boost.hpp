@@ -17,11 +17,35 @@
 #if defined __has_include
 #  if __has_include (<boost/thread/shared_mutex.hpp>)
 #    include <boost/thread/shared_mutex.hpp>
+#    include <functional>
 namespace mkg {
     template<typename NonConcurrentType, basic_shared_lockable LockableType = boost::shared_mutex, 
         template <typename...> typename SharedLockType = boost::shared_lock, 
         template <typename...> typename ExclusiveLockType = boost::unique_lock >
     class concurrent;
+
+    template<typename NonConcurrentType, std::size_t ShardCount = 16, 
+        typename Hash = std::hash<typename NonConcurrentType::key_type>,
+        basic_shared_lockable LockableType = boost::shared_mutex, 
+        template <typename...> typename SharedLockType = boost::shared_lock, 
+        template <typename...> typename ExclusiveLockType = boost::unique_lock >
+    class sharded_concurrent;
+
+    template<typename NonConcurrentType, std::size_t StripeCount = 64, 
+        basic_shared_lockable LockableType = boost::shared_mutex, 
+        template <typename...> typename SharedLockType = boost::shared_lock, 
+        template <typename...> typename ExclusiveLockType = boost::unique_lock >
+    class striped_concurrent;
+
+    template<>
+    struct lock_traits<boost::shared_lock> {
+        static constexpr boost::adopt_lock_t adopt_lock = {};
+    };
+
+    template<>
+    struct lock_traits<boost::unique_lock> {
+        static constexpr boost::adopt_lock_t adopt_lock = {};
+    };
 }
 #  else
 #  error "Boost implementation of concurrent wrapper requires boost/thread/shared_mutex.hpp to be available."
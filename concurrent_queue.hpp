@@ -0,0 +1,631 @@
+/**
+ * ______________________________________________________
+ * Lock-free multi-producer multi-consumer queues.
+ *
+ * @file 	concurrent_queue.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <atomic>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace mkg {
+
+    namespace detail {
+        /**
+         * @brief Retry `attempt` until it yields a truthy result; spins with `backoff`, then blocks on `event`.
+         */
+        template<typename Attempt>
+        auto wait_until(event_count & event, Attempt attempt) {
+            backoff waiter;
+            for(;;) {
+                if(auto result = attempt()) {
+                    return result;
+                }
+                if(waiter.pause()) {
+                    continue;
+                }
+                const auto key = event.prepare_wait();
+                if(auto result = attempt()) {
+                    event.cancel_wait();
+                    return result;
+                }
+                event.wait(key);
+            }
+        }
+
+        /**
+         * Uninitialized storage for a single queue element.
+         */
+        template<typename T>
+        struct element_storage {
+            template<typename... Args>
+            void construct(Args && ... args) noexcept {
+                ::new (static_cast<void*>(bytes)) T(std::forward<Args>(args)...);
+            }
+
+            /**
+             * @brief Move the element out, and end its lifetime.
+             */
+            T extract() noexcept {
+                T & element = *std::launder(reinterpret_cast<T*>(bytes));
+                T result{ std::move(element) };
+                element.~T();
+                return result;
+            }
+
+            void destroy() noexcept {
+                std::launder(reinterpret_cast<T*>(bytes))->~T();
+            }
+
+            alignas(T) std::byte bytes [sizeof(T)];
+        };
+
+        template<typename T, typename... Args>
+        concept nothrow_queue_constructible = std::is_nothrow_constructible_v<T, Args...>;
+    }
+
+    /**
+     * Type requirements of queue elements; elements are moved in and out of the queue after
+     * their slot is claimed, which must not fail half way.
+     */
+    template<typename T>
+    concept queue_element = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>;
+
+    /**
+     * A bounded, lock-free multi-producer multi-consumer queue (Vyukov's ring buffer).
+     *
+     * Every slot carries a sequence number telling whether it is free or full for the current lap,
+     * so producers and consumers only contend on their own position counter, and never on each other.
+     * Batch operations claim several consecutive slots with a single compare-and-swap.
+     *
+     * Blocking `push`/`pop` spin briefly, then park on `std::atomic::wait`; non-blocking counterparts
+     * never wait for other threads.
+     *
+     * @tparam T Element type
+     */
+    template<queue_element T>
+    class bounded_concurrent_queue : private noncopyable {
+    public:
+        using value_type = T;
+
+        /**
+         * @brief Construct an empty queue.
+         *
+         * @param capacity Maximum amount of elements, rounded up to a power of two
+         */
+        explicit bounded_concurrent_queue(std::size_t capacity) :
+            mask{ std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1 },
+            cells{ std::make_unique<cell[]>(mask + 1) } {
+            for(std::size_t i = 0; i <= mask; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~bounded_concurrent_queue() {
+            const auto last = enqueue_position.load(std::memory_order_relaxed);
+            for(auto position = dequeue_position.load(std::memory_order_relaxed); position != last; ++position) {
+                cells[position & mask].element.destroy();
+            }
+        }
+
+        /**
+         * @brief Append an element, unless the queue is full.
+         *
+         * @return false if the queue is full; `value` is left untouched
+         */
+        template<typename U>
+        requires std::constructible_from<T, U&&>
+        bool try_push(U && value) {
+            if constexpr (!detail::nothrow_queue_constructible<T, U&&>) {
+                // Construct beforehand, so a throwing constructor can not leave a claimed slot behind.
+                T element{ std::forward<U>(value) };
+                return try_push(std::move(element));
+            } else {
+                std::size_t position;
+                if(claim(enqueue_position, 1, 0, position) == 0) {
+                    return false;
+                }
+                auto & slot = cells[position & mask];
+                slot.element.construct(std::forward<U>(value));
+                slot.sequence.store(position + 1, std::memory_order_release);
+                not_empty.notify();
+                return true;
+            }
+        }
+
+        /**
+         * @brief Construct an element in place, unless the queue is full.
+         */
+        template<typename... Args>
+        requires std::constructible_from<T, Args&&...>
+        bool try_emplace(Args && ... args) {
+            return try_push(T(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief Remove the first element, unless the queue is empty.
+         */
+        std::optional<T> try_pop() {
+            std::size_t position;
+            if(claim(dequeue_position, 1, 1, position) == 0) {
+                return std::nullopt;
+            }
+            auto & slot = cells[position & mask];
+            std::optional<T> result{ slot.element.extract() };
+            slot.sequence.store(position + mask + 1, std::memory_order_release);
+            not_full.notify();
+            return result;
+        }
+
+        /**
+         * @brief Append an element, waiting while the queue is full.
+         */
+        template<typename U>
+        requires std::constructible_from<T, U&&>
+        void push(U && value) {
+            if constexpr (!detail::nothrow_queue_constructible<T, U&&>) {
+                T element{ std::forward<U>(value) };
+                push(std::move(element));
+            } else {
+                // `try_push` only consumes `value` on success.
+                detail::wait_until(not_full, [&] { return try_push(std::forward<U>(value)); });
+            }
+        }
+
+        /**
+         * @brief Remove the first element, waiting while the queue is empty.
+         */
+        T pop() {
+            return *detail::wait_until(not_empty, [this] { return try_pop(); });
+        }
+
+        /**
+         * @brief Append up to `count` elements read from `first`, as many as fit; never waits.
+         *
+         * @return Amount of elements appended (and read from `first`)
+         */
+        template<std::input_iterator Iterator>
+        requires std::constructible_from<T, std::iter_reference_t<Iterator>>
+        std::size_t push_n(Iterator first, std::size_t count) {
+            if constexpr (!detail::nothrow_queue_constructible<T, std::iter_reference_t<Iterator>>) {
+                std::size_t pushed = 0;
+                for(; pushed < count && try_push(*first); ++pushed, ++first) {}
+                return pushed;
+            } else {
+                std::size_t position;
+                const auto claimed = claim(enqueue_position, count, 0, position);
+                for(std::size_t i = 0; i < claimed; ++i, ++first) {
+                    auto & slot = cells[(position + i) & mask];
+                    slot.element.construct(*first);
+                    slot.sequence.store(position + i + 1, std::memory_order_release);
+                }
+                if(claimed != 0) {
+                    not_empty.notify();
+                }
+                return claimed;
+            }
+        }
+
+        /**
+         * @brief Remove up to `count` elements, as many as available, writing them to `out`; never waits.
+         *
+         * @note Writing to `out` must not throw.
+         *
+         * @return Amount of elements removed
+         */
+        template<typename OutputIterator>
+        requires std::output_iterator<OutputIterator, T>
+        std::size_t pop_n(OutputIterator out, std::size_t count) {
+            std::size_t position;
+            const auto claimed = claim(dequeue_position, count, 1, position);
+            for(std::size_t i = 0; i < claimed; ++i) {
+                auto & slot = cells[(position + i) & mask];
+                T element{ slot.element.extract() };
+                slot.sequence.store(position + i + mask + 1, std::memory_order_release);
+                *out = std::move(element);
+                ++out;
+            }
+            if(claimed != 0) {
+                not_full.notify();
+            }
+            return claimed;
+        }
+
+        /**
+         * @brief Maximum amount of elements.
+         */
+        std::size_t capacity() const noexcept {
+            return mask + 1;
+        }
+
+        /**
+         * @brief Amount of elements; only a hint while other threads modify the queue.
+         */
+        std::size_t approximate_size() const noexcept {
+            const auto dequeued = dequeue_position.load(std::memory_order_relaxed);
+            const auto enqueued = enqueue_position.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+    private:
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            detail::element_storage<T> element;
+        };
+
+        static std::ptrdiff_t distance(std::size_t sequence, std::size_t position) noexcept {
+            return static_cast<std::ptrdiff_t>(sequence - position);
+        }
+
+        /**
+         * @brief Claim up to `wanted` consecutive slots by advancing `counter`. A slot at `position` is
+         * ready when its sequence is `position + lag`; 0 for producers (free), 1 for consumers (full).
+         *
+         * @return Amount of slots claimed, starting from `first`
+         */
+        std::size_t claim(std::atomic<std::size_t> & counter, std::size_t wanted, std::size_t lag, std::size_t & first) noexcept {
+            if(wanted == 0) {
+                return 0;
+            }
+            auto position = counter.load(std::memory_order_relaxed);
+            for(;;) {
+                const auto diff = distance(cells[position & mask].sequence.load(std::memory_order_acquire), position + lag);
+                if(diff < 0) {
+                    // Full (for producers) or empty (for consumers).
+                    return 0;
+                }
+                if(diff > 0) {
+                    // Another thread claimed `position` in the meantime.
+                    position = counter.load(std::memory_order_relaxed);
+                    continue;
+                }
+                // A slot stays ready until its position is claimed, which only we can do from here on.
+                std::size_t count = 1;
+                while(count < wanted &&
+                    distance(cells[(position + count) & mask].sequence.load(std::memory_order_acquire), position + count + lag) == 0) {
+                    ++count;
+                }
+                if(counter.compare_exchange_weak(position, position + count, std::memory_order_relaxed)) {
+                    first = position;
+                    return count;
+                }
+            }
+        }
+
+        const std::size_t mask;
+        const std::unique_ptr<cell[]> cells;
+        alignas(cache_line_size) std::atomic<std::size_t> enqueue_position = {0};
+        alignas(cache_line_size) std::atomic<std::size_t> dequeue_position = {0};
+        alignas(cache_line_size) detail::event_count not_empty;
+        detail::event_count not_full;
+    };
+
+    /**
+     * An unbounded, lock-free multi-producer multi-consumer queue, made of a linked list of fixed size
+     * segments.
+     *
+     * Producers claim slots of the tail segment with a single `fetch_add`, consumers claim slots of the
+     * head segment with a compare-and-swap; a new segment is only allocated every `SegmentSize` elements.
+     * Consumed segments are reclaimed once every thread which might still observe them has left,
+     * through an `rcu_domain`; consumers never wait for that, they retire segments and a later
+     * consumer (or the destructor) reclaims them once the grace period is over.
+     *
+     * @tparam T            Element type
+     * @tparam SegmentSize  Amount of elements per segment
+     */
+    template<queue_element T, std::size_t SegmentSize = 256>
+    requires (SegmentSize > 0)
+    class concurrent_queue : private noncopyable {
+    public:
+        using value_type = T;
+
+        concurrent_queue() : head{ new segment }, tail{ head.load(std::memory_order_relaxed) } {}
+
+        ~concurrent_queue() {
+            for(auto * current = head.load(std::memory_order_relaxed); current != nullptr; ) {
+                const auto produced = std::min(current->enqueue_index.load(std::memory_order_relaxed), SegmentSize);
+                for(auto index = current->dequeue_index.load(std::memory_order_relaxed); index < produced; ++index) {
+                    current->cells[index].element.destroy();
+                }
+                delete std::exchange(current, current->next.load(std::memory_order_relaxed));
+            }
+            delete_retired(reclaiming);
+            delete_retired(retired.load(std::memory_order_relaxed));
+        }
+
+        /**
+         * @brief Append an element; never waits for other threads, but may allocate.
+         */
+        template<typename U>
+        requires std::constructible_from<T, U&&>
+        void push(U && value) {
+            if constexpr (!detail::nothrow_queue_constructible<T, U&&>) {
+                T element{ std::forward<U>(value) };
+                push(std::move(element));
+            } else {
+                {
+                    const read_section section{ domain };
+                    for(;;) {
+                        auto * current = tail.load(std::memory_order_acquire);
+                        const auto index = current->enqueue_index.fetch_add(1, std::memory_order_relaxed);
+                        if(index < SegmentSize) {
+                            publish(current->cells[index], std::forward<U>(value));
+                            break;
+                        }
+                        extend(current);
+                    }
+                }
+                not_empty.notify();
+            }
+        }
+
+        /**
+         * @brief Append an element; the queue is never full, so this always succeeds.
+         */
+        template<typename U>
+        requires std::constructible_from<T, U&&>
+        bool try_push(U && value) {
+            push(std::forward<U>(value));
+            return true;
+        }
+
+        /**
+         * @brief Construct an element in place at the end of the queue.
+         */
+        template<typename... Args>
+        requires std::constructible_from<T, Args&&...>
+        void emplace(Args && ... args) {
+            push(T(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief Remove the first element, unless the queue is empty.
+         */
+        std::optional<T> try_pop() {
+            std::optional<T> result;
+            pop_some(1, [&result](T && element) noexcept { result.emplace(std::move(element)); });
+            return result;
+        }
+
+        /**
+         * @brief Remove the first element, waiting while the queue is empty.
+         */
+        T pop() {
+            return *detail::wait_until(not_empty, [this] { return try_pop(); });
+        }
+
+        /**
+         * @brief Append `count` elements read from `first`; claims slots for the whole batch at once.
+         *
+         * @return `count`
+         */
+        template<std::input_iterator Iterator>
+        requires std::constructible_from<T, std::iter_reference_t<Iterator>>
+        std::size_t push_n(Iterator first, std::size_t count) {
+            if constexpr (!detail::nothrow_queue_constructible<T, std::iter_reference_t<Iterator>>) {
+                for(std::size_t i = 0; i < count; ++i, ++first) {
+                    push(*first);
+                }
+            } else {
+                {
+                    const read_section section{ domain };
+                    for(auto remaining = count; remaining != 0; ) {
+                        auto * current = tail.load(std::memory_order_acquire);
+                        const auto index = current->enqueue_index.fetch_add(remaining, std::memory_order_relaxed);
+                        if(index < SegmentSize) {
+                            const auto claimed = std::min(remaining, SegmentSize - index);
+                            for(std::size_t i = 0; i < claimed; ++i, ++first) {
+                                publish(current->cells[index + i], *first);
+                            }
+                            remaining -= claimed;
+                        }
+                        if(remaining != 0) {
+                            extend(current);
+                        }
+                    }
+                }
+                if(count != 0) {
+                    not_empty.notify();
+                }
+            }
+            return count;
+        }
+
+        /**
+         * @brief Remove up to `count` elements, as many as available, writing them to `out`; never waits
+         * for an element to be pushed.
+         *
+         * @note Writing to `out` must not throw.
+         *
+         * @return Amount of elements removed
+         */
+        template<typename OutputIterator>
+        requires std::output_iterator<OutputIterator, T>
+        std::size_t pop_n(OutputIterator out, std::size_t count) {
+            std::size_t popped = 0;
+            while(popped < count) {
+                const auto taken = pop_some(count - popped, [&out](T && element) noexcept {
+                    *out = std::move(element);
+                    ++out;
+                });
+                if(taken == 0) {
+                    break;
+                }
+                popped += taken;
+            }
+            return popped;
+        }
+
+    private:
+        struct cell {
+            std::atomic<bool> ready = {false};
+            detail::element_storage<T> element;
+        };
+
+        struct segment {
+            alignas(cache_line_size) std::atomic<std::size_t> enqueue_index = {0};
+            alignas(cache_line_size) std::atomic<std::size_t> dequeue_index = {0};
+            alignas(cache_line_size) std::atomic<segment*> next = {nullptr};
+            /// Link of the retired segments list
+            segment * next_retired = nullptr;
+            std::array<cell, SegmentSize> cells;
+        };
+
+        using domain_t = rcu_domain<>;
+
+        /**
+         * Scoped read-side critical section; segments observed inside are not reclaimed until it ends.
+         */
+        struct read_section {
+            explicit read_section(domain_t & domain) noexcept : domain{ domain }, token{ domain.read_lock() } {}
+            ~read_section() { domain.read_unlock(token); }
+            domain_t & domain;
+            domain_t::token token;
+        };
+
+        template<typename U>
+        static void publish(cell & slot, U && value) noexcept {
+            slot.element.construct(std::forward<U>(value));
+            slot.ready.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @brief Make sure the full segment `current` has a successor, and move the tail onto it.
+         */
+        void extend(segment * current) {
+            auto * successor = current->next.load(std::memory_order_acquire);
+            if(successor == nullptr) {
+                auto fresh = std::make_unique<segment>();
+                if(current->next.compare_exchange_strong(successor, fresh.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    successor = fresh.release();
+                }
+            }
+            tail.compare_exchange_strong(current, successor, std::memory_order_release, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Claim up to `wanted` elements of the head segment, and hand them to `consume`.
+         *
+         * @return Amount of elements consumed; 0 if the queue is empty
+         */
+        template<typename Consumer>
+        std::size_t pop_some(std::size_t wanted, Consumer && consume) {
+            std::size_t consumed = 0;
+            {
+                const read_section section{ domain };
+                for(;;) {
+                    auto * current = head.load(std::memory_order_acquire);
+                    auto index = current->dequeue_index.load(std::memory_order_relaxed);
+                    if(index >= SegmentSize) {
+                        auto * successor = current->next.load(std::memory_order_acquire);
+                        if(successor == nullptr) {
+                            break;
+                        }
+                        auto * expected = current;
+                        if(head.compare_exchange_strong(expected, successor, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                            // The tail must not be left behind on a segment which is about to be reclaimed.
+                            expected = current;
+                            tail.compare_exchange_strong(expected, successor, std::memory_order_release, std::memory_order_relaxed);
+                            retire(current);
+                        }
+                        continue;
+                    }
+                    const auto produced = std::min(current->enqueue_index.load(std::memory_order_acquire), SegmentSize);
+                    if(index >= produced) {
+                        break;
+                    }
+                    const auto claimed = std::min(wanted, produced - index);
+                    if(current->dequeue_index.compare_exchange_weak(index, index + claimed, std::memory_order_relaxed)) {
+                        for(std::size_t i = 0; i < claimed; ++i) {
+                            auto & slot = current->cells[index + i];
+                            // The producer claimed this slot, but might not have finished constructing the element yet.
+                            for(detail::backoff waiter; !slot.ready.load(std::memory_order_acquire); ) {
+                                waiter.pause_or_sleep();
+                            }
+                            consume(slot.element.extract());
+                        }
+                        consumed = claimed;
+                        break;
+                    }
+                }
+            }
+            if(unreclaimed.load(std::memory_order_relaxed) != 0) {
+                reclaim();
+            }
+            return consumed;
+        }
+
+        /**
+         * @brief Queue the segment `current`, which has just been unlinked from the head, for reclamation.
+         */
+        void retire(segment * current) noexcept {
+            unreclaimed.fetch_add(1, std::memory_order_relaxed);
+            current->next_retired = retired.load(std::memory_order_relaxed);
+            while(!retired.compare_exchange_weak(current->next_retired, current, std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+
+        /**
+         * @brief Reclaim the retired segments whose grace period is over, without waiting for it; only
+         * one consumer reclaims at a time, the others return right away.
+         */
+        void reclaim() {
+            std::unique_lock<std::mutex> guard{ reclaim_mutex, std::try_to_lock };
+            if(!guard.owns_lock()) {
+                return;
+            }
+            if(reclaiming == nullptr) {
+                // Segments retired from now on wait for the next grace period.
+                reclaiming = retired.exchange(nullptr, std::memory_order_acquire);
+                if(reclaiming == nullptr) {
+                    return;
+                }
+            }
+            if(domain.try_synchronize()) {
+                unreclaimed.fetch_sub(delete_retired(std::exchange(reclaiming, nullptr)), std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Delete a list of retired segments.
+         *
+         * @return Amount of segments deleted
+         */
+        static std::size_t delete_retired(segment * current) noexcept {
+            std::size_t deleted = 0;
+            for(; current != nullptr; ++deleted) {
+                delete std::exchange(current, current->next_retired);
+            }
+            return deleted;
+        }
+
+        alignas(cache_line_size) std::atomic<segment*> head;
+        alignas(cache_line_size) std::atomic<segment*> tail;
+        domain_t domain;
+        alignas(cache_line_size) std::atomic<segment*> retired = {nullptr};
+        std::atomic<std::size_t> unreclaimed = {0};
+        std::mutex reclaim_mutex;
+        /// Retired segments waiting for the pending grace period (guarded by `reclaim_mutex`)
+        segment * reclaiming = nullptr;
+        alignas(cache_line_size) detail::event_count not_empty;
+    };
+}
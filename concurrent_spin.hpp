@@ -0,0 +1,40 @@
+/**
+ * ______________________________________________________
+ * Concurrent wrapper, defaulted with the adaptive spin-then-park lock.
+ * 
+ * @file 	concurrent_spin.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <shared_mutex>
+#include <mutex>
+#include <functional>
+
+namespace mkg {
+    template<typename NonConcurrentType, basic_shared_lockable LockableType = spin_shared_mutex<>, 
+        template <typename...> typename SharedLockType = std::shared_lock, 
+        template <typename...> typename ExclusiveLockType = std::unique_lock >
+    class concurrent;
+
+    template<typename NonConcurrentType, std::size_t ShardCount = 16, 
+        typename Hash = std::hash<typename NonConcurrentType::key_type>,
+        basic_shared_lockable LockableType = spin_shared_mutex<>, 
+        template <typename...> typename SharedLockType = std::shared_lock, 
+        template <typename...> typename ExclusiveLockType = std::unique_lock >
+    class sharded_concurrent;
+
+    template<typename NonConcurrentType, std::size_t StripeCount = 64, 
+        basic_shared_lockable LockableType = spin_shared_mutex<>, 
+        template <typename...> typename SharedLockType = std::shared_lock, 
+        template <typename...> typename ExclusiveLockType = std::unique_lock >
+    class striped_concurrent;
+}
@@ -13,13 +13,28 @@
 #pragma once
 
 #include "concurrent.hpp"
+#include "lockable_upgrade.hpp"
 
 #include <shared_mutex>
 #include <mutex>
+#include <functional>
 
 namespace mkg {
     template<typename NonConcurrentType, basic_shared_lockable LockableType = std::shared_mutex, 
         template <typename...> typename SharedLockType = std::shared_lock, 
         template <typename...> typename ExclusiveLockType = std::unique_lock >
     class concurrent;
+
+    template<typename NonConcurrentType, std::size_t ShardCount = 16, 
+        typename Hash = std::hash<typename NonConcurrentType::key_type>,
+        basic_shared_lockable LockableType = std::shared_mutex, 
+        template <typename...> typename SharedLockType = std::shared_lock, 
+        template <typename...> typename ExclusiveLockType = std::unique_lock >
+    class sharded_concurrent;
+
+    template<typename NonConcurrentType, std::size_t StripeCount = 64, 
+        basic_shared_lockable LockableType = std::shared_mutex, 
+        template <typename...> typename SharedLockType = std::shared_lock, 
+        template <typename...> typename ExclusiveLockType = std::unique_lock >
+    class striped_concurrent;
 }
\ No newline at end of file
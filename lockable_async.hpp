@@ -0,0 +1,161 @@
+/**
+ * ______________________________________________________
+ * Reader-writer lock with asynchronous (queued) acquisition.
+ * 
+ * @file 	lockable_async.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+namespace mkg {
+
+    /**
+     * A reader-writer lock which queues waiters instead of blocking them, so coroutines can wait for it 
+     * (see `concurrent::async_read_access()` and `concurrent::async_write_access()`) without occupying a thread. 
+     * The queue holds any amount of waiters; each one lives in the awaiting coroutine's frame.
+     * 
+     * The lock is granted in FIFO order, except that readers at the head of the queue are admitted 
+     * together as one batch. New requests queue up behind existing waiters, so writers are not starved.
+     * 
+     * Blocking `lock()`/`lock_shared()` calls are supported too; they queue the calling thread the same way.
+     */
+    class async_shared_mutex : private noncopyable {
+    public:
+        async_shared_mutex() = default;
+
+        void lock() { blocking_wait(true); }
+
+        bool try_lock() {
+            std::lock_guard guard{ state_lock };
+            if(owners != 0 || head) {
+                return false;
+            }
+            owners = writer;
+            return true;
+        }
+
+        void unlock() { release(); }
+
+        void lock_shared() { blocking_wait(false); }
+
+        bool try_lock_shared() {
+            std::lock_guard guard{ state_lock };
+            if(owners == writer || head) {
+                return false;
+            }
+            ++owners;
+            return true;
+        }
+
+        void unlock_shared() { release(); }
+
+        /**
+         * @brief Acquire the lock for `waiter` immediately if possible, otherwise queue it.
+         * 
+         * @return true if the lock has been acquired; false if `waiter` is queued, and will be resumed once 
+         * the lock has been acquired on its behalf
+         */
+        bool lock_async(detail::async_waiter & waiter) {
+            std::lock_guard guard{ state_lock };
+            if(!head && (waiter.exclusive ? owners == 0 : owners != writer)) {
+                owners = waiter.exclusive ? writer : owners + 1;
+                return true;
+            }
+            waiter.next = nullptr;
+            (head ? tail->next : head) = &waiter;
+            tail = &waiter;
+            return false;
+        }
+
+    private:
+        static constexpr std::ptrdiff_t writer = -1;
+
+        /**
+         * Lets a thread block in the queue like a coroutine would.
+         */
+        struct blocked_thread : detail::async_waiter {
+            async_shared_mutex * owner = nullptr;
+            std::atomic<bool> granted = {false};
+        };
+
+        void blocking_wait(bool exclusive) {
+            blocked_thread waiter;
+            waiter.exclusive = exclusive;
+            waiter.owner = this;
+            waiter.resume = [](detail::async_waiter & self) {
+                auto & blocked = static_cast<blocked_thread &>(self);
+                auto & parked = blocked.owner->parking.slot_of(&blocked);
+                // The waiter may return (and destroy itself) as soon as it observes this store, so it is
+                // woken through an event count of the lock instead of its own memory.
+                blocked.granted.store(true, std::memory_order_release);
+                parked.notify();
+            };
+            if(lock_async(waiter)) {
+                return;
+            }
+            auto & parked = parking.slot_of(&waiter);
+            while(!waiter.granted.load(std::memory_order_acquire)) {
+                const auto key = parked.prepare_wait();
+                if(waiter.granted.load(std::memory_order_acquire)) {
+                    parked.cancel_wait();
+                    break;
+                }
+                parked.wait(key);
+            }
+        }
+
+        /**
+         * @brief Release one ownership, then grant the lock to the next batch of waiters, if it became free.
+         */
+        void release() {
+            detail::async_waiter * granted = nullptr;
+            {
+                std::lock_guard guard{ state_lock };
+                owners = (owners == writer) ? 0 : owners - 1;
+                if(owners != 0 || !head) {
+                    return;
+                }
+                granted = head;
+                if(head->exclusive) {
+                    owners = writer;
+                    head = head->next;
+                    granted->next = nullptr;
+                } else {
+                    auto * last = head;
+                    for(++owners; last->next && !last->next->exclusive; last = last->next) {
+                        ++owners;
+                    }
+                    head = last->next;
+                    last->next = nullptr;
+                }
+            }
+            // Resumed waiters may destroy themselves right away, so step to the next one first.
+            while(granted) {
+                auto * next = granted->next;
+                granted->resume(*granted);
+                granted = next;
+            }
+        }
+
+        std::mutex state_lock;
+        std::ptrdiff_t owners = 0;
+        detail::async_waiter * head = nullptr;
+        detail::async_waiter * tail = nullptr;
+        /// Blocked threads park here (see `blocking_wait()`)
+        detail::parking_table<> parking;
+    };
+
+    static_assert(async_lockable<async_shared_mutex>);
+}
@@ -0,0 +1,232 @@
+/**
+ * ______________________________________________________
+ * NUMA-aware cohort reader-writer lock.
+ *
+ * @file 	lockable_cohort.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace mkg {
+
+    namespace detail {
+        /**
+         * @brief NUMA node of the calling thread; sampled once per thread, so it stays stable while the
+         * thread holds a lock, even if the thread migrates. 0 where the node can not be determined.
+         */
+        inline std::size_t this_numa_node() noexcept {
+            thread_local const std::size_t node = [] {
+                unsigned cpu = 0, current = 0;
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+                if(getcpu(&cpu, &current) != 0) {
+                    current = 0;
+                }
+#endif
+                return static_cast<std::size_t>(current);
+            }();
+            return node;
+        }
+    }
+
+    /**
+     * A NUMA-aware reader-writer lock (cohort lock, after Dice et al.'s C-TKT-TKT and Calciu et al.'s C-RW-WP).
+     *
+     * Writers first take the ticket lock of their own node, then a global ticket lock. When a writer releases
+     * the lock while another writer of the same node is waiting, it passes the global lock within the node
+     * (the cohort), so the lock and the resource's cache lines stay on one socket. After `CohortBound`
+     * consecutive passes, the global lock is released, and the next node gets its turn.
+     *
+     * Reader presence is tracked in per-node counters, each on its own cache line. A writer raises the
+     * writer flag (which turns new readers away), then waits for the reader counters to drain; writers
+     * have preference over new readers. Waiters spin briefly, then park on `std::atomic::wait`.
+     *
+     * Shared ownership must be released by the thread which acquired it.
+     *
+     * @tparam NodeCount    Amount of NUMA nodes to distinguish; nodes beyond it share a cohort
+     * @tparam CohortBound  Maximum amount of consecutive handoffs within a node
+     */
+    template<std::size_t NodeCount = 8, std::uint32_t CohortBound = 64>
+    class cohort_shared_mutex : private noncopyable {
+        static_assert(NodeCount > 0);
+    public:
+        cohort_shared_mutex() = default;
+
+        void lock() noexcept {
+            const auto index = detail::this_numa_node() % NodeCount;
+            auto & local = nodes[index];
+            const auto ticket = local.next.fetch_add(1, std::memory_order_relaxed);
+            detail::spin_wait(local.serving, [ticket](std::uint32_t served) { return served != ticket; });
+            if(!local.inherited) {
+                const auto global_ticket = global_next.fetch_add(1, std::memory_order_relaxed);
+                detail::spin_wait(global_serving, [global_ticket](std::uint32_t served) { return served != global_ticket; });
+                raise_writer_flag();
+            }
+            owner = index;
+        }
+
+        bool try_lock() noexcept {
+            const auto index = detail::this_numa_node() % NodeCount;
+            auto & local = nodes[index];
+            if(!try_acquire(local.next, local.serving)) {
+                return false;
+            }
+            // Nobody was waiting on the node lock, so the global lock can not have been passed to us.
+            if(!try_acquire(global_next, global_serving)) {
+                release(local.serving);
+                return false;
+            }
+            writer.store(owned);
+            for(const auto & current : nodes) {
+                if(current.readers.load() != 0) {
+                    release_writer_flag();
+                    release(global_serving);
+                    release(local.serving);
+                    return false;
+                }
+            }
+            owner = index;
+            return true;
+        }
+
+        void unlock() noexcept {
+            auto & local = nodes[owner];
+            const auto served = local.serving.load(std::memory_order_relaxed);
+            const bool local_waiters = local.next.load(std::memory_order_relaxed) != served + 1;
+            if(local_waiters && local.passes < CohortBound) {
+                // Keep the global lock (and the writer flag) within the cohort.
+                ++local.passes;
+                local.inherited = true;
+            } else {
+                local.passes = 0;
+                local.inherited = false;
+                release_writer_flag();
+                release(global_serving);
+            }
+            release(local.serving);
+        }
+
+        void lock_shared() noexcept {
+            auto & readers = node_readers();
+            detail::backoff waiter;
+            for(;;) {
+                if(try_enter(readers)) {
+                    return;
+                }
+                if(const auto current = writer.load(std::memory_order_relaxed); current != free && !waiter.pause()) {
+                    park(current);
+                }
+            }
+        }
+
+        bool try_lock_shared() noexcept {
+            return try_enter(node_readers());
+        }
+
+        void unlock_shared() noexcept {
+            auto & readers = node_readers();
+            readers.fetch_sub(1);
+            // Sequentially consistent with `raise_writer_flag()`; either the writer observes our
+            // decrement, or we observe the writer and wake it up.
+            if(writer.load() != free) {
+                readers.notify_all();
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t free = 0;
+        static constexpr std::uint32_t owned = 1;
+        static constexpr std::uint32_t owned_and_parked = 2;
+
+        struct node {
+            // Node-local ticket lock; `passes` and `inherited` are only accessed by its owner.
+            alignas(cache_line_size) std::atomic<std::uint32_t> next = {0};
+            std::atomic<std::uint32_t> serving = {0};
+            std::uint32_t passes = 0;
+            bool inherited = false;
+            alignas(cache_line_size) std::atomic<std::uint32_t> readers = {0};
+        };
+
+        std::atomic<std::uint32_t> & node_readers() noexcept { return nodes[detail::this_numa_node() % NodeCount].readers; }
+
+        static bool try_acquire(std::atomic<std::uint32_t> & next, const std::atomic<std::uint32_t> & serving) noexcept {
+            auto expected = serving.load(std::memory_order_relaxed);
+            return next.compare_exchange_strong(expected, expected + 1, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        static void release(std::atomic<std::uint32_t> & serving) noexcept {
+            serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            serving.notify_all();
+        }
+
+        void raise_writer_flag() noexcept {
+            // Only the owner of the global lock modifies the flag (readers only mark it as parked).
+            writer.store(owned);
+            for(auto & current : nodes) {
+                detail::backoff waiter;
+                for(auto readers = current.readers.load(); readers != 0; readers = current.readers.load()) {
+                    if(!waiter.pause()) {
+                        current.readers.wait(readers);
+                    }
+                }
+            }
+        }
+
+        void release_writer_flag() noexcept {
+            if(writer.exchange(free, std::memory_order_release) == owned_and_parked) {
+                writer.notify_all();
+            }
+        }
+
+        bool try_enter(std::atomic<std::uint32_t> & readers) noexcept {
+            if(writer.load(std::memory_order_relaxed) != free) {
+                return false;
+            }
+            readers.fetch_add(1);
+            // Re-validate, a writer which raised the flag in between might have scanned our counter already.
+            if(writer.load() == free) {
+                return true;
+            }
+            readers.fetch_sub(1);
+            readers.notify_all();
+            return false;
+        }
+
+        /**
+         * @brief Block until the writer flag changes from `current`, after flagging that a waiter is parked.
+         */
+        void park(std::uint32_t current) noexcept {
+            if(current == free) {
+                return;
+            }
+            if(current == owned && !writer.compare_exchange_strong(current, owned_and_parked, std::memory_order_relaxed)) {
+                return;
+            }
+            writer.wait(owned_and_parked, std::memory_order_relaxed);
+        }
+
+        alignas(cache_line_size) std::atomic<std::uint32_t> global_next = {0};
+        std::atomic<std::uint32_t> global_serving = {0};
+        std::size_t owner = 0;
+        alignas(cache_line_size) std::atomic<std::uint32_t> writer = {free};
+        std::array<node, NodeCount> nodes;
+    };
+
+    static_assert(shared_lockable<cohort_shared_mutex<>> && lockable<cohort_shared_mutex<>>);
+}
@@ -0,0 +1,149 @@
+/**
+ * ______________________________________________________
+ * Flat-combining lockable decorator.
+ * 
+ * @file 	lockable_combining.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mkg {
+
+    /**
+     * A `Lockable` decorator which implements flat combining for `concurrent::write(fn)`. Instead of 
+     * taking turns on the lock, writers post their operation to a per-thread publication slot, and 
+     * whichever thread acquires the lock runs all pending operations in one batch, while the resource 
+     * stays hot in its cache. The other writers only wait for their own slot to be marked as done.
+     * 
+     * Lock operations (and so all accessors) are forwarded as-is, and exclude combined operations 
+     * as usual.
+     * 
+     * @tparam LockableType A type which satisfies the `Lockable` named requirement (eg. std::shared_mutex)
+     * @tparam SlotCount Amount of publication slots; threads sharing a slot fall back to plain locking while it is taken
+     */
+    template<lockable LockableType, std::size_t SlotCount = 64>
+    class flat_combining {
+        static_assert(SlotCount > 0);
+    public:
+        void lock() { underlying.lock(); }
+        void unlock() { underlying.unlock(); }
+        bool try_lock() { return underlying.try_lock(); }
+
+        template<typename Duration>
+        bool try_lock_for(const Duration & duration) requires timed_lockable<LockableType> { return underlying.try_lock_for(duration); }
+
+        template<typename TimePoint>
+        bool try_lock_until(const TimePoint & time_point) requires timed_lockable<LockableType> { return underlying.try_lock_until(time_point); }
+
+        void lock_shared() requires basic_shared_lockable<LockableType> { underlying.lock_shared(); }
+        void unlock_shared() requires basic_shared_lockable<LockableType> { underlying.unlock_shared(); }
+        bool try_lock_shared() requires shared_lockable<LockableType> { return underlying.try_lock_shared(); }
+
+        template<typename Duration>
+        bool try_lock_shared_for(const Duration & duration) requires shared_timed_lockable<LockableType> {
+            return underlying.try_lock_shared_for(duration);
+        }
+
+        template<typename TimePoint>
+        bool try_lock_shared_until(const TimePoint & time_point) requires shared_timed_lockable<LockableType> {
+            return underlying.try_lock_shared_until(time_point);
+        }
+
+        /**
+         * @brief Statistics of the decorated `LockableType`, if it is instrumented.
+         */
+        lock_metrics metrics() const noexcept requires instrumented_lockable<LockableType> { return underlying.metrics(); }
+
+        /**
+         * @brief Run `operation` under the exclusive lock, either on the calling thread (along with 
+         * the other pending operations) or on another thread which is combining. Returns after 
+         * `operation` has been run.
+         */
+        void combine(detail::combining_operation & operation) {
+            if(underlying.try_lock()) {
+                // Uncontended; no need to publish.
+                run(operation);
+                combine_pending();
+                return;
+            }
+            auto & slot = slots[detail::this_thread_index() % SlotCount];
+            auto expected = empty;
+            if(!slot.state.compare_exchange_strong(expected, claimed, std::memory_order_acquire, std::memory_order_relaxed)) {
+                // Another thread owns the slot; do it the old-fashioned way.
+                underlying.lock();
+                run(operation);
+                underlying.unlock();
+                return;
+            }
+            slot.operation = &operation;
+            slot.state.store(pending, std::memory_order_release);
+            pending_operations.fetch_add(1, std::memory_order_release);
+
+            detail::backoff waiter;
+            while(slot.state.load(std::memory_order_acquire) != done) {
+                if(underlying.try_lock()) {
+                    combine_pending();
+                } else if(!waiter.pause()) {
+                    // The combiner might have missed our slot; block and become the combiner instead.
+                    underlying.lock();
+                    combine_pending();
+                }
+            }
+            slot.state.store(empty, std::memory_order_release);
+        }
+
+    private:
+        static constexpr std::uint32_t empty = 0;
+        static constexpr std::uint32_t claimed = 1;
+        static constexpr std::uint32_t pending = 2;
+        static constexpr std::uint32_t done = 3;
+
+        struct alignas(cache_line_size) publication_slot {
+            std::atomic<std::uint32_t> state = {empty};
+            detail::combining_operation * operation = nullptr;
+        };
+
+        static void run(detail::combining_operation & operation) noexcept {
+            try {
+                operation.run(operation);
+            } catch(...) {
+                operation.failure = std::current_exception();
+            }
+        }
+
+        /**
+         * @brief Run every pending operation, then release the (already acquired) lock.
+         */
+        void combine_pending() {
+            // Every counted operation is already visible as pending, so the scan can stop early.
+            auto outstanding = pending_operations.load(std::memory_order_acquire);
+            for(auto slot = slots.begin(); outstanding > 0 && slot != slots.end(); ++slot) {
+                if(slot->state.load(std::memory_order_acquire) == pending) {
+                    run(*slot->operation);
+                    pending_operations.fetch_sub(1, std::memory_order_relaxed);
+                    slot->state.store(done, std::memory_order_release);
+                    --outstanding;
+                }
+            }
+            underlying.unlock();
+        }
+
+        LockableType underlying;
+        alignas(cache_line_size) std::atomic<std::size_t> pending_operations = {0};
+        std::array<publication_slot, SlotCount> slots;
+    };
+
+    static_assert(combining_lockable<flat_combining<std::mutex>>);
+}
@@ -0,0 +1,191 @@
+/**
+ * ______________________________________________________
+ * Compact (two byte) reader-writer lock.
+ * 
+ * @file 	lockable_compact.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mkg {
+
+    /**
+     * A reader-writer lock which occupies two bytes, for resources which are small and numerous 
+     * (eg. millions of `concurrent<session_state>`), where a 40-56 byte `std::shared_mutex` would 
+     * dominate the memory and cache footprint.
+     * 
+     * Waiters spin briefly, then park on `std::atomic::wait`. For a 16-bit word, the standard library
+     * keeps the wait queues in a process-wide table hashed by address (like a parking lot), so the 
+     * lock itself only needs a "some waiter is parked" bit.
+     * 
+     * The lock word;
+     * 
+     * - bit 15     : exclusive owner
+     * - bit 14     : some waiter is parked
+     * - bit 13     : a writer is waiting; new readers hold back, so writers are not starved
+     * - bits 0..12 : amount of shared owners
+     */
+    class compact_shared_mutex : private noncopyable {
+    public:
+        compact_shared_mutex() = default;
+
+        void lock() noexcept {
+            detail::backoff waiter;
+            for(auto current = state.load(std::memory_order_relaxed);;) {
+                if(acquire_exclusive(current)) {
+                    return;
+                }
+                if(!(current & writer_pending)) {
+                    state.compare_exchange_weak(current, current | writer_pending, std::memory_order_relaxed);
+                    continue;
+                }
+                if(!waiter.pause()) {
+                    park(current);
+                }
+                current = state.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool try_lock() noexcept {
+            auto current = state.load(std::memory_order_relaxed);
+            while(!(current & (writer | readers_mask))) {
+                if(acquire_exclusive(current)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<typename Rep, typename Period>
+        bool try_lock_for(const std::chrono::duration<Rep, Period> & duration) {
+            return try_lock_until(std::chrono::steady_clock::now() + duration);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_lock_until(const std::chrono::time_point<Clock, Duration> & time_point) {
+            detail::backoff waiter;
+            for(auto current = state.load(std::memory_order_relaxed);;) {
+                if(acquire_exclusive(current)) {
+                    return true;
+                }
+                if(Clock::now() >= time_point) {
+                    // Let the readers we held back in; other waiting writers will raise the flag again.
+                    if(state.fetch_and(static_cast<std::uint16_t>(~(writer_pending | parked)), std::memory_order_relaxed) & parked) {
+                        state.notify_all();
+                    }
+                    return false;
+                }
+                if(!(current & writer_pending)) {
+                    state.compare_exchange_weak(current, current | writer_pending, std::memory_order_relaxed);
+                    continue;
+                }
+                waiter.pause_or_sleep();
+                current = state.load(std::memory_order_relaxed);
+            }
+        }
+
+        void unlock() noexcept {
+            if(state.fetch_and(static_cast<std::uint16_t>(~(writer | parked)), std::memory_order_release) & parked) {
+                state.notify_all();
+            }
+        }
+
+        void lock_shared() noexcept {
+            detail::backoff waiter;
+            for(auto current = state.load(std::memory_order_relaxed);;) {
+                if(can_enter_shared(current)) {
+                    if(state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+                if(!waiter.pause()) {
+                    park(current);
+                }
+                current = state.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool try_lock_shared() noexcept {
+            auto current = state.load(std::memory_order_relaxed);
+            while(can_enter_shared(current)) {
+                if(state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<typename Rep, typename Period>
+        bool try_lock_shared_for(const std::chrono::duration<Rep, Period> & duration) {
+            return try_lock_shared_until(std::chrono::steady_clock::now() + duration);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> & time_point) {
+            detail::backoff waiter;
+            while(!try_lock_shared()) {
+                if(Clock::now() >= time_point) {
+                    return false;
+                }
+                waiter.pause_or_sleep();
+            }
+            return true;
+        }
+
+        void unlock_shared() noexcept {
+            const auto previous = state.fetch_sub(1, std::memory_order_release);
+            // Only the last reader can let a waiter in.
+            if((previous & readers_mask) == 1 && (previous & parked)) {
+                state.fetch_and(static_cast<std::uint16_t>(~parked), std::memory_order_relaxed);
+                state.notify_all();
+            }
+        }
+
+    private:
+        static constexpr std::uint16_t writer = 1u << 15;
+        static constexpr std::uint16_t parked = 1u << 14;
+        static constexpr std::uint16_t writer_pending = 1u << 13;
+        static constexpr std::uint16_t readers_mask = writer_pending - 1;
+
+        static bool can_enter_shared(std::uint16_t current) noexcept {
+            return !(current & (writer | writer_pending)) && (current & readers_mask) != readers_mask;
+        }
+
+        /**
+         * @brief Take the exclusive ownership if nobody owns the lock, clearing the pending writer flag.
+         */
+        bool acquire_exclusive(std::uint16_t & current) noexcept {
+            return !(current & (writer | readers_mask)) && state.compare_exchange_weak(current, 
+                static_cast<std::uint16_t>((current & ~writer_pending) | writer), std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Block until the lock word changes from `current`, after flagging that a waiter is parked.
+         */
+        void park(std::uint16_t current) noexcept {
+            if(!(current & parked) && !state.compare_exchange_strong(current, current | parked, std::memory_order_relaxed)) {
+                return;
+            }
+            state.wait(current | parked, std::memory_order_relaxed);
+        }
+
+        std::atomic<std::uint16_t> state = {0};
+    };
+
+    static_assert(sizeof(compact_shared_mutex) == 2 && alignof(compact_shared_mutex) <= 2, 
+        "compact_shared_mutex must add no more than two bytes to a concurrent<T>.");
+    static_assert(shared_timed_lockable<compact_shared_mutex> && timed_lockable<compact_shared_mutex>);
+}
@@ -0,0 +1,158 @@
+/**
+ * ______________________________________________________
+ * Distributed ("big-reader") reader-writer lock.
+ * 
+ * @file 	lockable_distributed.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mkg {
+
+    /**
+     * A reader-writer lock for read-mostly resources. Reader presence is tracked in per-thread striped 
+     * counters, each on its own cache line, so readers running on different threads do not modify a 
+     * shared cache line and the read-side cost does not grow with the core count. 
+     * 
+     * Writers pay for it instead; a writer raises the writer flag (which turns new readers away), 
+     * then waits for the reader counter of every stripe to drain. Waiting writers have priority 
+     * over new readers.
+     * 
+     * Shared ownership must be released by the thread which acquired it.
+     * 
+     * @tparam StripeCount Amount of reader counter stripes; ideally not less than the amount of reader threads
+     */
+    template<std::size_t StripeCount = 32>
+    class distributed_shared_mutex : private noncopyable {
+        static_assert(StripeCount > 0);
+    public:
+        distributed_shared_mutex() = default;
+
+        void lock() noexcept {
+            detail::backoff waiter;
+            for(;;) {
+                auto expected = free;
+                if(writer.compare_exchange_weak(expected, owned)) {
+                    break;
+                }
+                if(!waiter.pause()) {
+                    park(expected);
+                }
+            }
+            for(auto & current : stripes) {
+                wait_until_drained(current.readers);
+            }
+        }
+
+        bool try_lock() noexcept {
+            auto expected = free;
+            if(!writer.compare_exchange_strong(expected, owned)) {
+                return false;
+            }
+            for(const auto & current : stripes) {
+                if(current.readers.load() != 0) {
+                    unlock();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void unlock() noexcept {
+            if(writer.exchange(free, std::memory_order_release) == owned_and_parked) {
+                writer.notify_all();
+            }
+        }
+
+        void lock_shared() noexcept {
+            auto & readers = stripe();
+            detail::backoff waiter;
+            for(;;) {
+                if(try_enter(readers)) {
+                    return;
+                }
+                if(const auto current = writer.load(std::memory_order_relaxed); current != free && !waiter.pause()) {
+                    park(current);
+                }
+            }
+        }
+
+        bool try_lock_shared() noexcept {
+            return try_enter(stripe());
+        }
+
+        void unlock_shared() noexcept {
+            auto & readers = stripe();
+            readers.fetch_sub(1);
+            // Sequentially consistent with `writer.compare_exchange` of `lock()`; either the writer 
+            // observes our decrement, or we observe the writer and wake it up.
+            if(writer.load() != free) {
+                readers.notify_all();
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t free = 0;
+        static constexpr std::uint32_t owned = 1;
+        static constexpr std::uint32_t owned_and_parked = 2;
+
+        struct alignas(cache_line_size) reader_stripe {
+            std::atomic<std::uint32_t> readers = {0};
+        };
+
+        std::atomic<std::uint32_t> & stripe() noexcept { return stripes[detail::this_thread_index() % StripeCount].readers; }
+
+        bool try_enter(std::atomic<std::uint32_t> & readers) noexcept {
+            if(writer.load(std::memory_order_relaxed) != free) {
+                return false;
+            }
+            readers.fetch_add(1);
+            // Re-validate, a writer which raised the flag in between might have scanned our stripe already.
+            if(writer.load() == free) {
+                return true;
+            }
+            readers.fetch_sub(1);
+            readers.notify_all();
+            return false;
+        }
+
+        void wait_until_drained(std::atomic<std::uint32_t> & readers) noexcept {
+            detail::backoff waiter;
+            for(auto current = readers.load(); current != 0; current = readers.load()) {
+                if(!waiter.pause()) {
+                    readers.wait(current);
+                }
+            }
+        }
+
+        /**
+         * @brief Block until the writer flag changes from `current`, after flagging that a waiter is parked.
+         */
+        void park(std::uint32_t current) noexcept {
+            if(current == free) {
+                return;
+            }
+            if(current == owned && !writer.compare_exchange_strong(current, owned_and_parked, std::memory_order_relaxed)) {
+                return;
+            }
+            writer.wait(owned_and_parked, std::memory_order_relaxed);
+        }
+
+        std::atomic<std::uint32_t> writer = {free};
+        std::array<reader_stripe, StripeCount> stripes;
+    };
+
+    static_assert(shared_lockable<distributed_shared_mutex<>> && lockable<distributed_shared_mutex<>>);
+}
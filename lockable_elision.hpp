@@ -0,0 +1,266 @@
+/**
+ * ______________________________________________________
+ * Hardware lock elision (Intel TSX/RTM) lockable decorator.
+ * 
+ * @file 	lockable_elision.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#   include <cpuid.h>
+#   include <immintrin.h>
+#   define MKG_CONCURRENT_HAS_RTM 1
+#   define MKG_CONCURRENT_RTM_TARGET __attribute__((target("rtm")))
+#else
+#   define MKG_CONCURRENT_HAS_RTM 0
+#   define MKG_CONCURRENT_RTM_TARGET
+#endif
+
+namespace mkg {
+
+    /**
+     * Statistics of an `elided` lockable.
+     */
+    struct elision_metrics {
+        /**
+         * Amount of aborted transactions
+         */
+        std::uint64_t aborts = 0;
+
+        /**
+         * Amount of acquisitions which gave up on elision and locked the decorated lockable 
+         * (not counted when the processor lacks RTM support)
+         */
+        std::uint64_t fallbacks = 0;
+    };
+
+    namespace detail {
+        /**
+         * @brief Whether the processor supports restricted transactional memory (CPUID.07H:EBX.RTM[bit 11]).
+         * Detected once, at runtime.
+         */
+        inline bool rtm_supported() noexcept {
+#if MKG_CONCURRENT_HAS_RTM
+            static const bool supported = [] {
+                unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+                return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 11));
+            }();
+            return supported;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * Elided acquisitions held by the calling thread, one entry per acquisition, so every release takes the
+         * path of the acquisition it releases (`_xtest()` only tells whether *some* transaction is running, eg.
+         * that of another lock acquired later). Acquisitions beyond `capacity` are not elided.
+         */
+        struct elided_locks {
+            static constexpr std::size_t capacity = 16;
+
+            bool full() const noexcept { return size == capacity; }
+
+            void insert(const void * lock) noexcept { entries[size++] = lock; }
+
+            /**
+             * @brief Forget an elided acquisition of `lock`; false if the calling thread holds none.
+             */
+            bool erase(const void * lock) noexcept {
+                for(std::size_t i = size; i-- > 0; ) {
+                    if(entries[i] == lock) {
+                        entries[i] = entries[--size];
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::array<const void *, capacity> entries;
+            std::size_t size = 0;
+        };
+
+        inline elided_locks & this_thread_elided_locks() noexcept {
+            thread_local elided_locks locks;
+            return locks;
+        }
+    }
+
+    /**
+     * A `Lockable` decorator which elides the decorated lock with hardware transactions (Intel TSX/RTM). 
+     * Critical sections run speculatively, without acquiring `LockableType`, so threads whose accesses 
+     * do not conflict (eg. writers of different buckets of a small hash table) run in parallel. Conflicting
+     * critical sections are aborted and retried by the hardware.
+     * 
+     * After `Retries` aborts (or right away, if the processor lacks RTM support), the acquisition falls back 
+     * to locking `LockableType`, which also aborts all elided critical sections. Critical sections which 
+     * perform system calls or I/O always abort, so only use it for short, memory-only critical sections.
+     * Every thread records its elided acquisitions, so locks may be released in any order (as `std::unique_lock`
+     * allows), eg. a fallback acquisition of one lock while an elided critical section of another is running.
+     * 
+     * @tparam LockableType A type which satisfies the `SharedLockable` named requirement (eg. std::shared_mutex)
+     * @tparam Retries Amount of transaction attempts before falling back to `LockableType`
+     */
+    template<shared_lockable LockableType, unsigned Retries = 3>
+    requires mkg::lockable<LockableType>
+    class elided : private noncopyable {
+    public:
+        elided() = default;
+
+        MKG_CONCURRENT_RTM_TARGET void lock() {
+            if(!try_elide()) {
+                underlying.lock();
+                hold_fallback();
+            }
+        }
+
+        MKG_CONCURRENT_RTM_TARGET bool try_lock() {
+            if(try_elide(1)) {
+                return true;
+            }
+            if(underlying.try_lock()) {
+                hold_fallback();
+                return true;
+            }
+            return false;
+        }
+
+        MKG_CONCURRENT_RTM_TARGET void unlock() {
+            if(release_elided()) {
+                commit();
+            } else {
+                release_fallback();
+                underlying.unlock();
+            }
+        }
+
+        MKG_CONCURRENT_RTM_TARGET void lock_shared() {
+            if(!try_elide()) {
+                underlying.lock_shared();
+                hold_fallback();
+            }
+        }
+
+        MKG_CONCURRENT_RTM_TARGET bool try_lock_shared() {
+            if(try_elide(1)) {
+                return true;
+            }
+            if(underlying.try_lock_shared()) {
+                hold_fallback();
+                return true;
+            }
+            return false;
+        }
+
+        MKG_CONCURRENT_RTM_TARGET void unlock_shared() {
+            if(release_elided()) {
+                commit();
+            } else {
+                release_fallback();
+                underlying.unlock_shared();
+            }
+        }
+
+        /**
+         * @brief Whether critical sections are elided at all, on this processor.
+         */
+        static bool supported() noexcept { return detail::rtm_supported(); }
+
+        /**
+         * @brief Snapshot of the statistics recorded so far.
+         */
+        elision_metrics metrics() const noexcept {
+            return elision_metrics{ aborts.load(std::memory_order_relaxed), fallbacks.load(std::memory_order_relaxed) };
+        }
+
+    private:
+        static constexpr unsigned lock_busy = 0xff;
+
+        /**
+         * @brief Try to start a transaction, in which the lock is (speculatively) free.
+         * 
+         * @return true if running in a transaction; false if the caller has to acquire the lock for real
+         */
+        MKG_CONCURRENT_RTM_TARGET bool try_elide([[maybe_unused]] unsigned attempts = Retries) noexcept {
+#if MKG_CONCURRENT_HAS_RTM
+            auto & held = detail::this_thread_elided_locks();
+            if(detail::rtm_supported() && !held.full()) {
+                for(unsigned attempt = 0; attempt < attempts; ++attempt) {
+                    const auto status = _xbegin();
+                    if(status == _XBEGIN_STARTED) {
+                        // Reading the holder count adds it to our read set; a fallback acquisition aborts us.
+                        if(fallback_holders.load(std::memory_order_relaxed) != 0) {
+                            _xabort(lock_busy);
+                        }
+                        // Part of the transaction, so an abort forgets it as well.
+                        held.insert(this);
+                        return true;
+                    }
+                    aborts.fetch_add(1, std::memory_order_relaxed);
+                    if((status & _XABORT_EXPLICIT) && _XABORT_CODE(status) == lock_busy) {
+                        // Wait for the lock to become free, instead of aborting over and over again.
+                        while(fallback_holders.load(std::memory_order_relaxed) != 0) {
+                            detail::cpu_relax();
+                        }
+                    } else if(!(status & (_XABORT_RETRY | _XABORT_CONFLICT))) {
+                        // Capacity overflow, system call, etc.; retrying will not help.
+                        break;
+                    }
+                }
+                fallbacks.fetch_add(1, std::memory_order_relaxed);
+            }
+#endif
+            return false;
+        }
+
+        /**
+         * @brief Forget an elided acquisition of this lock by the calling thread, if it holds one.
+         * 
+         * @return true if the released acquisition was elided; false if it holds `underlying`
+         */
+        bool release_elided() noexcept {
+            return detail::rtm_supported() && detail::this_thread_elided_locks().erase(this);
+        }
+
+        MKG_CONCURRENT_RTM_TARGET static void commit() noexcept {
+#if MKG_CONCURRENT_HAS_RTM
+            _xend();
+#endif
+        }
+
+        // Without RTM, there is nobody to tell.
+        void hold_fallback() noexcept { 
+            if(detail::rtm_supported()) {
+                fallback_holders.fetch_add(1, std::memory_order_relaxed); 
+            }
+        }
+
+        void release_fallback() noexcept { 
+            if(detail::rtm_supported()) {
+                fallback_holders.fetch_sub(1, std::memory_order_relaxed); 
+            }
+        }
+
+        /**
+         * Amount of threads holding `underlying` (shared or exclusively); elided critical sections must 
+         * observe zero.
+         */
+        alignas(cache_line_size) std::atomic<std::uint32_t> fallback_holders = {0};
+        LockableType underlying;
+        alignas(cache_line_size) std::atomic<std::uint64_t> aborts = {0};
+        std::atomic<std::uint64_t> fallbacks = {0};
+    };
+}
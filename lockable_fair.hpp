@@ -0,0 +1,197 @@
+/**
+ * ______________________________________________________
+ * Fair reader-writer locks, and fairness policy selection.
+ * 
+ * @file 	lockable_fair.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <mutex>
+
+namespace mkg {
+
+    /**
+     * A phase-fair reader-writer lock (Brandenburg & Anderson's PF-T). Reader and writer phases alternate;
+     * a writer waits for at most one reader phase, and readers wait for at most one writer phase, so 
+     * neither side can be starved. Writers are served in FIFO (ticket) order.
+     */
+    class phase_fair_shared_mutex : private noncopyable {
+    public:
+        phase_fair_shared_mutex() = default;
+
+        void lock() noexcept {
+            const auto ticket = writer_requests.fetch_add(1, std::memory_order_relaxed);
+            detail::spin_wait(writer_completions, [ticket](std::uint32_t served) { return served != ticket; });
+            enter_writer_phase(ticket);
+        }
+
+        bool try_lock() noexcept {
+            auto ticket = writer_completions.load(std::memory_order_acquire);
+            if(!writer_requests.compare_exchange_strong(ticket, ticket + 1, std::memory_order_relaxed)) {
+                return false;
+            }
+            auto entered = reader_exits.load(std::memory_order_acquire);
+            if(!reader_entries.compare_exchange_strong(entered, entered | writer_present | (ticket & phase_id), std::memory_order_acquire)) {
+                // Readers are inside; hand our ticket over to the next writer without touching the readers.
+                writer_completions.fetch_add(1, std::memory_order_release);
+                writer_completions.notify_all();
+                return false;
+            }
+            return true;
+        }
+
+        void unlock() noexcept {
+            reader_entries.fetch_and(~writer_bits, std::memory_order_release);
+            reader_entries.notify_all();
+            writer_completions.fetch_add(1, std::memory_order_release);
+            writer_completions.notify_all();
+        }
+
+        void lock_shared() noexcept {
+            const auto writer = reader_entries.fetch_add(reader_increment, std::memory_order_acquire) & writer_bits;
+            if(writer != 0) {
+                // Wait for the current writer phase (identified by the phase bit) to end.
+                detail::spin_wait(reader_entries, [writer](std::uint32_t entries) { return (entries & writer_bits) == writer; });
+            }
+        }
+
+        bool try_lock_shared() noexcept {
+            auto entries = reader_entries.load(std::memory_order_relaxed);
+            while(!(entries & writer_bits)) {
+                if(reader_entries.compare_exchange_weak(entries, entries + reader_increment, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void unlock_shared() noexcept {
+            reader_exits.fetch_add(reader_increment, std::memory_order_release);
+            reader_exits.notify_all();
+        }
+
+    private:
+        static constexpr std::uint32_t reader_increment = 0x100;
+        static constexpr std::uint32_t writer_bits = 0x3;
+        static constexpr std::uint32_t writer_present = 0x2;
+        static constexpr std::uint32_t phase_id = 0x1;
+
+        /**
+         * @brief Block new readers, then wait for the readers which are already inside to leave.
+         */
+        void enter_writer_phase(std::uint32_t ticket) noexcept {
+            const auto entered = reader_entries.fetch_add(writer_present | (ticket & phase_id), std::memory_order_acquire);
+            detail::spin_wait(reader_exits, [entered](std::uint32_t exits) { return exits != entered; });
+        }
+
+        alignas(cache_line_size) std::atomic<std::uint32_t> reader_entries = {0};
+        alignas(cache_line_size) std::atomic<std::uint32_t> reader_exits = {0};
+        alignas(cache_line_size) std::atomic<std::uint32_t> writer_requests = {0};
+        std::atomic<std::uint32_t> writer_completions = {0};
+    };
+
+    /**
+     * A FIFO (ticket) reader-writer lock (Mellor-Crummey & Scott). Every request draws a ticket, and is 
+     * granted strictly in ticket order; consecutive readers are granted together. Nobody is starved, 
+     * and wait times are bounded by the amount of requests ahead.
+     */
+    class ticket_shared_mutex : private noncopyable {
+    public:
+        ticket_shared_mutex() = default;
+
+        void lock() noexcept {
+            const auto ticket = requests.fetch_add(writer_increment, std::memory_order_relaxed);
+            // Wait until every request ahead of us has completed.
+            detail::spin_wait(completions, [ticket](std::uint32_t completed) { return completed != ticket; });
+        }
+
+        bool try_lock() noexcept {
+            auto ticket = completions.load(std::memory_order_acquire);
+            return requests.compare_exchange_strong(ticket, ticket + writer_increment, std::memory_order_relaxed);
+        }
+
+        void unlock() noexcept {
+            completions.fetch_add(writer_increment, std::memory_order_release);
+            completions.notify_all();
+        }
+
+        void lock_shared() noexcept {
+            const auto ticket = requests.fetch_add(reader_increment, std::memory_order_relaxed);
+            // Wait until every writer ahead of us has completed.
+            detail::spin_wait(completions, [ticket](std::uint32_t completed) { return (completed & writer_mask) != (ticket & writer_mask); });
+        }
+
+        bool try_lock_shared() noexcept {
+            auto ticket = requests.load(std::memory_order_relaxed);
+            while((completions.load(std::memory_order_acquire) & writer_mask) == (ticket & writer_mask)) {
+                if(requests.compare_exchange_weak(ticket, ticket + reader_increment, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void unlock_shared() noexcept {
+            completions.fetch_add(reader_increment, std::memory_order_release);
+            completions.notify_all();
+        }
+
+    private:
+        // Both fields wrap around consistently in `requests` and `completions`, so carries are harmless.
+        static constexpr std::uint32_t writer_increment = 1;
+        static constexpr std::uint32_t reader_increment = 1u << 16;
+        static constexpr std::uint32_t writer_mask = reader_increment - 1;
+
+        alignas(cache_line_size) std::atomic<std::uint32_t> requests = {0};
+        alignas(cache_line_size) std::atomic<std::uint32_t> completions = {0};
+    };
+
+    static_assert(shared_lockable<phase_fair_shared_mutex> && lockable<phase_fair_shared_mutex>);
+    static_assert(shared_lockable<ticket_shared_mutex> && lockable<ticket_shared_mutex>);
+
+    /**
+     * Fairness policies between readers and writers of a resource.
+     */
+    enum class fairness {
+        /** Readers are admitted while writers wait; best read throughput, writers may starve */
+        reader_preferring,
+        /** Waiting writers hold new readers back; readers may starve under a steady stream of writers */
+        writer_preferring,
+        /** Reader and writer phases alternate; bounded waits for both */
+        phase_fair,
+        /** Requests are granted strictly in arrival order */
+        fifo
+    };
+
+    namespace detail {
+        template<fairness Policy> struct fair_lockable;
+        template<> struct fair_lockable<fairness::reader_preferring> { using type = spin_shared_mutex<reader_preference>; };
+        template<> struct fair_lockable<fairness::writer_preferring> { using type = spin_shared_mutex<writer_preference>; };
+        template<> struct fair_lockable<fairness::phase_fair> { using type = phase_fair_shared_mutex; };
+        template<> struct fair_lockable<fairness::fifo> { using type = ticket_shared_mutex; };
+    }
+
+    /**
+     * The reader-writer lock implementing the fairness `Policy`.
+     */
+    template<fairness Policy>
+    using fair_shared_mutex = typename detail::fair_lockable<Policy>::type;
+
+    /**
+     * A `concurrent` resource, whose readers and writers are served according to the fairness `Policy`.
+     */
+    template<typename NonConcurrentType, fairness Policy>
+    using fair_concurrent = concurrent<NonConcurrentType, fair_shared_mutex<Policy>, std::shared_lock, std::unique_lock>;
+}
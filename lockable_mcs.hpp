@@ -0,0 +1,164 @@
+/**
+ * ______________________________________________________
+ * Queue-based (MCS) fair reader-writer lock.
+ *
+ * @file 	lockable_mcs.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+#include "lockable_spin.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace mkg {
+
+    /**
+     * A FIFO reader-writer lock built on an MCS queue. Every acquiring thread appends a node to the queue,
+     * and spins on a flag of its own node, so passing the lock on touches the cache line of a single waiter
+     * instead of waking all of them.
+     *
+     * The thread at the head of the queue waits until its mode is compatible with the current owners, enters,
+     * and then passes the head on right away; so consecutive readers enter together, and nodes are only needed
+     * while acquiring. They live on the acquiring thread's stack (within `lock()` / `lock_shared()`), thus the
+     * lock needs no allocation, and works with `std::shared_lock` / `std::unique_lock` as usual.
+     *
+     * Waiters spin briefly, then park on words owned by the lock, never on nodes (which may be gone by the
+     * time they are notified): a queued thread parks on the event count its node hashes to, and only the head
+     * of the queue waits on the lock state; so a parked handoff or release still wakes a single thread, save
+     * for the rare waiters which share its slot.
+     */
+    class mcs_shared_mutex : private noncopyable {
+    public:
+        mcs_shared_mutex() = default;
+
+        void lock() noexcept {
+            queue_node self;
+            enqueue(self);
+            detail::spin_wait(state, [](std::uint32_t current) { return current != 0; });
+            state.store(writer, std::memory_order_relaxed);
+            pass_head(self);
+        }
+
+        bool try_lock() noexcept {
+            queue_node self;
+            if(!try_enqueue(self)) {
+                return false;
+            }
+            const bool acquired = state.load(std::memory_order_acquire) == 0;
+            if(acquired) {
+                state.store(writer, std::memory_order_relaxed);
+            }
+            pass_head(self);
+            return acquired;
+        }
+
+        void unlock() noexcept {
+            state.store(0, std::memory_order_release);
+            // Only the head of the queue waits on the state.
+            state.notify_one();
+        }
+
+        void lock_shared() noexcept {
+            queue_node self;
+            enqueue(self);
+            detail::spin_wait(state, [](std::uint32_t current) { return (current & writer) != 0; });
+            // Only the head of the queue enters, so the writer bit can not be raised in between.
+            state.fetch_add(1, std::memory_order_relaxed);
+            pass_head(self);
+        }
+
+        bool try_lock_shared() noexcept {
+            queue_node self;
+            if(!try_enqueue(self)) {
+                return false;
+            }
+            const bool acquired = (state.load(std::memory_order_acquire) & writer) == 0;
+            if(acquired) {
+                state.fetch_add(1, std::memory_order_relaxed);
+            }
+            pass_head(self);
+            return acquired;
+        }
+
+        void unlock_shared() noexcept {
+            if(state.fetch_sub(1, std::memory_order_release) == 1) {
+                state.notify_one();
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t writer = 1u << 31;
+
+        struct queue_node {
+            std::atomic<queue_node*> next = {nullptr};
+            std::atomic<bool> is_head = {false};
+        };
+
+        /**
+         * @brief Append `self` to the queue, and wait until it becomes the head.
+         */
+        void enqueue(queue_node & self) noexcept {
+            auto * predecessor = tail.exchange(&self, std::memory_order_acq_rel);
+            if(predecessor == nullptr) {
+                return;
+            }
+            predecessor->next.store(&self, std::memory_order_release);
+            auto & parked = parking.slot_of(&self);
+            detail::backoff waiter;
+            while(!self.is_head.load(std::memory_order_acquire)) {
+                if(waiter.pause()) {
+                    continue;
+                }
+                const auto key = parked.prepare_wait();
+                if(self.is_head.load(std::memory_order_acquire)) {
+                    parked.cancel_wait();
+                    break;
+                }
+                parked.wait(key);
+            }
+        }
+
+        /**
+         * @brief Become the head of the queue, only if the queue is empty.
+         */
+        bool try_enqueue(queue_node & self) noexcept {
+            queue_node * expected = nullptr;
+            return tail.compare_exchange_strong(expected, &self, std::memory_order_acq_rel, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Pass the head of the queue on from `self` to its successor, if any.
+         */
+        void pass_head(queue_node & self) noexcept {
+            auto * successor = self.next.load(std::memory_order_acquire);
+            if(successor == nullptr) {
+                auto * expected = &self;
+                if(tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    return;
+                }
+                // A successor has swapped the tail already, but not linked itself yet.
+                for(detail::backoff waiter; (successor = self.next.load(std::memory_order_acquire)) == nullptr; ) {
+                    waiter.pause_or_sleep();
+                }
+            }
+            // The successor may return (and destroy its node) as soon as it observes this store.
+            auto & parked = parking.slot_of(successor);
+            successor->is_head.store(true, std::memory_order_release);
+            parked.notify();
+        }
+
+        alignas(cache_line_size) std::atomic<queue_node*> tail = {nullptr};
+        alignas(cache_line_size) std::atomic<std::uint32_t> state = {0};
+        detail::parking_table<> parking;
+    };
+
+    static_assert(shared_lockable<mcs_shared_mutex> && lockable<mcs_shared_mutex>);
+}
@@ -0,0 +1,291 @@
+/**
+ * ______________________________________________________
+ * Lock order checking (debug) lockable decorator.
+ *
+ * @file 	lockable_ranked.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <source_location>
+#include <utility>
+
+/**
+ * Lock order checks of `ranked` are compiled in unless `NDEBUG` is defined; define as 1 to keep
+ * them in optimized (eg. canary) builds, or as 0 to remove them from debug builds.
+ */
+#if !defined(MKG_CONCURRENT_LOCK_ORDER_CHECKS)
+#  if defined(NDEBUG)
+#    define MKG_CONCURRENT_LOCK_ORDER_CHECKS 0
+#  else
+#    define MKG_CONCURRENT_LOCK_ORDER_CHECKS 1
+#  endif
+#endif
+
+namespace mkg {
+
+    /**
+     * Rank of `ranked` locks which do not take part in lock order checks (only in recursion checks).
+     */
+    inline constexpr std::size_t unranked = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * Describes a lock acquisition which may deadlock, reported to the `lock_order_handler`.
+     */
+    struct lock_order_violation {
+        enum class violation_kind {
+            /// The acquiring thread holds the lock already
+            recursive_acquisition,
+            /// The acquiring thread holds a lock of a higher rank
+            rank_inversion
+        };
+
+        violation_kind kind;
+        const void * held_lock;
+        std::size_t held_rank;
+        std::source_location held_site;
+        const void * acquired_lock;
+        std::size_t acquired_rank;
+        std::source_location acquired_site;
+    };
+
+    using lock_order_handler = void (*)(const lock_order_violation &);
+
+    namespace detail {
+        /**
+         * @brief Print both call sites of `violation` to stderr, then abort.
+         */
+        inline void abort_on_lock_order_violation(const lock_order_violation & violation) noexcept {
+            const bool recursive = violation.kind == lock_order_violation::violation_kind::recursive_acquisition;
+            std::fprintf(stderr, "mkg::ranked: %s\n"
+                "  acquiring lock %p (rank %zu) at %s:%u in %s\n"
+                "  while holding %p (rank %zu), acquired at %s:%u in %s\n",
+                recursive ? "recursive acquisition" : "lock rank inversion",
+                violation.acquired_lock, violation.acquired_rank, violation.acquired_site.file_name(),
+                static_cast<unsigned>(violation.acquired_site.line()), violation.acquired_site.function_name(),
+                violation.held_lock, violation.held_rank, violation.held_site.file_name(),
+                static_cast<unsigned>(violation.held_site.line()), violation.held_site.function_name());
+            std::abort();
+        }
+
+        inline std::atomic<lock_order_handler> & lock_order_handler_slot() noexcept {
+            static std::atomic<lock_order_handler> handler = { &abort_on_lock_order_violation };
+            return handler;
+        }
+
+        /**
+         * Locks held by the calling thread, in acquisition order. Locks beyond `capacity` are not tracked.
+         */
+        struct held_locks {
+            struct entry {
+                const void * lock;
+                std::size_t rank;
+                std::source_location site;
+            };
+
+            static constexpr std::size_t capacity = 32;
+
+            std::array<entry, capacity> entries;
+            std::size_t size = 0;
+            /// Call site of the acquisition in progress, announced by `concurrent` (see `ranked_lockable`)
+            std::source_location pending_site;
+        };
+
+        inline held_locks & this_thread_held_locks() noexcept {
+            thread_local held_locks locks;
+            return locks;
+        }
+    }
+
+    /**
+     * @brief Replace the handler which is invoked on lock order violations (by default, `ranked` prints
+     * both call sites, then aborts). A handler which returns lets the acquisition proceed, eg. to only log
+     * violations in canary builds.
+     *
+     * @return The previous handler
+     */
+    inline lock_order_handler set_lock_order_handler(lock_order_handler handler) noexcept {
+        return detail::lock_order_handler_slot().exchange(handler);
+    }
+
+    /**
+     * A `Lockable` decorator which checks the lock order of the calling thread, in debug builds (see
+     * `MKG_CONCURRENT_LOCK_ORDER_CHECKS`). Every thread tracks the `ranked` locks it holds, together with the
+     * call sites of the accessor getters which acquired them; a blocking acquisition is reported if the thread
+     *
+     * - holds the same lock already (which deadlocks, or is undefined behavior for shared locks), or
+     * - holds a lock of a higher rank, or of the same rank at a higher address (`lock_all` order).
+     *
+     * Ranks are given at compile time, or at runtime via `concurrent::set_lock_rank()`. Locks of `unranked` rank
+     * are only checked for recursion. Without checks, every operation is forwarded as-is.
+     *
+     * ~~~cpp
+     * mkg::concurrent<accounts, mkg::ranked<std::shared_mutex, 1>> accounts;
+     * mkg::concurrent<journal, mkg::ranked<std::shared_mutex, 2>> journal;
+     * ~~~
+     *
+     * @tparam LockableType A type which satisfies the `BasicLockable` named requirement (eg. std::shared_mutex)
+     * @tparam Rank         Locks must be acquired in increasing rank order
+     */
+    template<basic_lockable LockableType, std::size_t Rank = unranked>
+    class ranked {
+    public:
+        void lock() { const auto site = check(true); underlying.lock(); push(site); }
+        void unlock() { pop(); underlying.unlock(); }
+
+        bool try_lock() requires mkg::lockable<LockableType> {
+            return attempt([this] { return underlying.try_lock(); });
+        }
+
+        template<typename Duration>
+        bool try_lock_for(const Duration & duration) requires timed_lockable<LockableType> {
+            return attempt([&] { return underlying.try_lock_for(duration); });
+        }
+
+        template<typename TimePoint>
+        bool try_lock_until(const TimePoint & time_point) requires timed_lockable<LockableType> {
+            return attempt([&] { return underlying.try_lock_until(time_point); });
+        }
+
+        void lock_shared() requires basic_shared_lockable<LockableType> {
+            const auto site = check(true);
+            underlying.lock_shared();
+            push(site);
+        }
+
+        void unlock_shared() requires basic_shared_lockable<LockableType> { pop(); underlying.unlock_shared(); }
+
+        bool try_lock_shared() requires shared_lockable<LockableType> {
+            return attempt([this] { return underlying.try_lock_shared(); });
+        }
+
+        template<typename Duration>
+        bool try_lock_shared_for(const Duration & duration) requires shared_timed_lockable<LockableType> {
+            return attempt([&] { return underlying.try_lock_shared_for(duration); });
+        }
+
+        template<typename TimePoint>
+        bool try_lock_shared_until(const TimePoint & time_point) requires shared_timed_lockable<LockableType> {
+            return attempt([&] { return underlying.try_lock_shared_until(time_point); });
+        }
+
+        /**
+         * @brief Announce the call site of the acquisition which follows (called by `concurrent`).
+         */
+        void acquiring_from([[maybe_unused]] const std::source_location & site) noexcept {
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+            detail::this_thread_held_locks().pending_site = site;
+#endif
+        }
+
+        /**
+         * @brief Assign a rank at runtime; overrides `Rank`.
+         */
+        void set_rank([[maybe_unused]] std::size_t rank) noexcept {
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+            current_rank = rank;
+#endif
+        }
+
+        std::size_t rank() const noexcept {
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+            return current_rank;
+#else
+            return Rank;
+#endif
+        }
+
+        /**
+         * @brief Statistics of the decorated `LockableType`, if it is instrumented.
+         */
+        lock_metrics metrics() const noexcept requires instrumented_lockable<LockableType> { return underlying.metrics(); }
+
+    private:
+        /**
+         * @brief Report the acquisition, if it might deadlock; first violation only.
+         *
+         * @param ordered Whether rank order applies (blocking acquisitions), besides recursion
+         * @return The call site of the acquisition
+         */
+        std::source_location check([[maybe_unused]] bool ordered) noexcept {
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+            auto & held = detail::this_thread_held_locks();
+            const auto site = std::exchange(held.pending_site, std::source_location{});
+            for(std::size_t i = 0; i < held.size; ++i) {
+                const auto & entry = held.entries[i];
+                const bool recursive = entry.lock == this;
+                const bool inverted = ordered && current_rank != unranked && entry.rank != unranked && (entry.rank > current_rank ||
+                    (entry.rank == current_rank && std::greater<const void *>{}(entry.lock, this)));
+                if(recursive || inverted) {
+                    const lock_order_violation violation{
+                        recursive ? lock_order_violation::violation_kind::recursive_acquisition : lock_order_violation::violation_kind::rank_inversion,
+                        entry.lock, entry.rank, entry.site, this, current_rank, site
+                    };
+                    detail::lock_order_handler_slot().load()(violation);
+                    break;
+                }
+            }
+            return site;
+#else
+            return {};
+#endif
+        }
+
+        /**
+         * @brief Run a non-blocking acquisition, which can only deadlock if it is recursive, and track it if it succeeds.
+         */
+        template<typename Attempt>
+        bool attempt(Attempt try_acquire) {
+            const auto site = check(false);
+            const bool success = try_acquire();
+            if(success) {
+                push(site);
+            }
+            return success;
+        }
+
+        void push([[maybe_unused]] const std::source_location & site) noexcept {
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+            auto & held = detail::this_thread_held_locks();
+            if(held.size < detail::held_locks::capacity) {
+                held.entries[held.size++] = { this, current_rank, site };
+            }
+#endif
+        }
+
+        void pop() noexcept {
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+            // Locks are not necessarily released in reverse acquisition order.
+            auto & held = detail::this_thread_held_locks();
+            for(std::size_t i = held.size; i-- > 0; ) {
+                if(held.entries[i].lock == this) {
+                    std::move(held.entries.begin() + static_cast<std::ptrdiff_t>(i) + 1,
+                        held.entries.begin() + static_cast<std::ptrdiff_t>(held.size), held.entries.begin() + static_cast<std::ptrdiff_t>(i));
+                    --held.size;
+                    return;
+                }
+            }
+#endif
+        }
+
+        LockableType underlying;
+#if MKG_CONCURRENT_LOCK_ORDER_CHECKS
+        std::size_t current_rank = Rank;
+#endif
+    };
+}
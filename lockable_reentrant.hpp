@@ -0,0 +1,252 @@
+/**
+ * ______________________________________________________
+ * Reentrant (nested acquisition reusing) lockable decorator.
+ *
+ * @file 	lockable_reentrant.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include <system_error>
+
+namespace mkg {
+
+    namespace detail {
+        /**
+         * Locks held by the calling thread through a `reentrant` decorator, with their depth. Locks
+         * beyond `capacity` are acquired without tracking (so they are not reentrant).
+         */
+        struct reentrant_locks {
+            struct entry {
+                const void * lock;
+                std::uint32_t shared_depth;
+                std::uint32_t exclusive_depth;
+                /// Mode the underlying lock is held in
+                bool exclusive;
+            };
+
+            static constexpr std::size_t capacity = 16;
+
+            /**
+             * @brief Entry of `lock`, or nullptr if the calling thread does not hold it.
+             */
+            entry * find(const void * lock) noexcept {
+                // Nested acquisitions are usually of the most recent lock.
+                for(std::size_t i = size; i-- > 0; ) {
+                    if(entries[i].lock == lock) {
+                        return &entries[i];
+                    }
+                }
+                return nullptr;
+            }
+
+            /**
+             * @brief Track `lock` as held, or return nullptr if the registry is full.
+             */
+            entry * insert(const void * lock, bool exclusive) noexcept {
+                if(size == capacity) {
+                    return nullptr;
+                }
+                entries[size] = { lock, exclusive ? 0u : 1u, exclusive ? 1u : 0u, exclusive };
+                return &entries[size++];
+            }
+
+            void erase(entry * released) noexcept {
+                *released = entries[--size];
+            }
+
+            std::array<entry, capacity> entries;
+            std::size_t size = 0;
+        };
+
+        inline reentrant_locks & this_thread_reentrant_locks() noexcept {
+            thread_local reentrant_locks locks;
+            return locks;
+        }
+    }
+
+    /**
+     * A `Lockable` decorator which makes nested acquisitions by the owning thread reuse the lock it holds,
+     * instead of locking again (which is undefined behavior for `std::shared_mutex`, and deadlocks as soon as a
+     * writer queues up in between). Every thread keeps a small registry of the `reentrant` locks it holds,
+     * with their depth; only the outermost acquisition and release reach `LockableType`.
+     *
+     * So helpers may take `const concurrent<T, reentrant<L>> &` and call `read_access_handle()`, no matter
+     * whether their caller holds an accessor already:
+     *
+     * - a nested shared acquisition is granted while the thread holds the lock shared or exclusive,
+     * - a nested exclusive acquisition is granted while the thread holds the lock exclusive,
+     * - an exclusive acquisition while the thread only holds the lock shared can not be granted (it would
+     *   deadlock on itself); `lock()` throws `std::system_error` (`resource_deadlock_would_occur`), which
+     *   terminates through the `noexcept` accessor getters of `concurrent`, and `try_lock()` variants fail.
+     *
+     * The underlying lock is released in the mode it was acquired in, once all nested ownership is released.
+     * Ownership must be released by the thread which acquired it. Composes with `ranked` as `reentrant<ranked<L>>`.
+     *
+     * @tparam LockableType A type which satisfies the `BasicLockable` named requirement (eg. std::shared_mutex)
+     */
+    template<basic_lockable LockableType>
+    class reentrant {
+    public:
+        void lock() {
+            auto & held = detail::this_thread_reentrant_locks();
+            if(auto * current = held.find(this)) {
+                nest_exclusive(*current);
+                return;
+            }
+            underlying.lock();
+            held.insert(this, true);
+        }
+
+        bool try_lock() requires mkg::lockable<LockableType> {
+            return attempt_exclusive([this] { return underlying.try_lock(); });
+        }
+
+        template<typename Duration>
+        bool try_lock_for(const Duration & duration) requires timed_lockable<LockableType> {
+            return attempt_exclusive([&] { return underlying.try_lock_for(duration); });
+        }
+
+        template<typename TimePoint>
+        bool try_lock_until(const TimePoint & time_point) requires timed_lockable<LockableType> {
+            return attempt_exclusive([&] { return underlying.try_lock_until(time_point); });
+        }
+
+        void unlock() {
+            release(&detail::reentrant_locks::entry::exclusive_depth);
+        }
+
+        void lock_shared() requires basic_shared_lockable<LockableType> {
+            auto & held = detail::this_thread_reentrant_locks();
+            if(auto * current = held.find(this)) {
+                ++current->shared_depth;
+                return;
+            }
+            underlying.lock_shared();
+            held.insert(this, false);
+        }
+
+        bool try_lock_shared() requires shared_lockable<LockableType> {
+            return attempt_shared([this] { return underlying.try_lock_shared(); });
+        }
+
+        template<typename Duration>
+        bool try_lock_shared_for(const Duration & duration) requires shared_timed_lockable<LockableType> {
+            return attempt_shared([&] { return underlying.try_lock_shared_for(duration); });
+        }
+
+        template<typename TimePoint>
+        bool try_lock_shared_until(const TimePoint & time_point) requires shared_timed_lockable<LockableType> {
+            return attempt_shared([&] { return underlying.try_lock_shared_until(time_point); });
+        }
+
+        void unlock_shared() requires basic_shared_lockable<LockableType> {
+            release(&detail::reentrant_locks::entry::shared_depth);
+        }
+
+        /**
+         * @brief Whether the calling thread holds this lock (in any mode).
+         */
+        bool held_by_this_thread() const noexcept {
+            return detail::this_thread_reentrant_locks().find(this) != nullptr;
+        }
+
+        void acquiring_from(const std::source_location & site) noexcept requires ranked_lockable<LockableType> {
+            underlying.acquiring_from(site);
+        }
+
+        void set_rank(std::size_t rank) noexcept requires ranked_lockable<LockableType> {
+            underlying.set_rank(rank);
+        }
+
+        std::size_t rank() const noexcept requires ranked_lockable<LockableType> { return underlying.rank(); }
+
+        /**
+         * @brief Statistics of the decorated `LockableType`, if it is instrumented.
+         */
+        lock_metrics metrics() const noexcept requires instrumented_lockable<LockableType> { return underlying.metrics(); }
+
+    private:
+        using entry = detail::reentrant_locks::entry;
+
+        static void nest_exclusive(entry & current) {
+            if(!current.exclusive) {
+                throw std::system_error{ std::make_error_code(std::errc::resource_deadlock_would_occur),
+                    "mkg::reentrant: exclusive acquisition while holding the lock shared" };
+            }
+            ++current.exclusive_depth;
+        }
+
+        template<typename Attempt>
+        bool attempt_exclusive(Attempt try_acquire) {
+            auto & held = detail::this_thread_reentrant_locks();
+            if(auto * current = held.find(this)) {
+                if(!current->exclusive) {
+                    return false;
+                }
+                ++current->exclusive_depth;
+                return true;
+            }
+            if(!try_acquire()) {
+                return false;
+            }
+            held.insert(this, true);
+            return true;
+        }
+
+        template<typename Attempt>
+        bool attempt_shared(Attempt try_acquire) {
+            auto & held = detail::this_thread_reentrant_locks();
+            if(auto * current = held.find(this)) {
+                ++current->shared_depth;
+                return true;
+            }
+            if(!try_acquire()) {
+                return false;
+            }
+            held.insert(this, false);
+            return true;
+        }
+
+        /**
+         * @brief Release one level of ownership (`depth` selects the mode); the underlying lock is released
+         * along with the last level.
+         */
+        void release(std::uint32_t entry::* depth) {
+            auto & held = detail::this_thread_reentrant_locks();
+            auto * current = held.find(this);
+            if(current == nullptr) {
+                // Acquired while the registry was full.
+                unlock_underlying(depth == &entry::exclusive_depth);
+                return;
+            }
+            --(current->*depth);
+            if(current->shared_depth == 0 && current->exclusive_depth == 0) {
+                const bool exclusive = current->exclusive;
+                held.erase(current);
+                unlock_underlying(exclusive);
+            }
+        }
+
+        void unlock_underlying(bool exclusive) {
+            if(exclusive) {
+                underlying.unlock();
+            } else if constexpr (basic_shared_lockable<LockableType>) {
+                underlying.unlock_shared();
+            }
+        }
+
+        LockableType underlying;
+    };
+}
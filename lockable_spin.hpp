@@ -0,0 +1,330 @@
+/**
+ * ______________________________________________________
+ * Adaptive spin-then-park reader-writer lock.
+ * 
+ * @file 	lockable_spin.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace mkg {
+
+    namespace detail {
+        /**
+         * Backoff policy for busy-waiting; spins with `cpu_relax` first, then yields the processor,
+         * and finally tells the caller to park (block) instead.
+         */
+        class backoff {
+        public:
+            static constexpr unsigned spin_limit = 64;
+            static constexpr unsigned yield_limit = spin_limit + 16;
+
+            /**
+             * @brief Wait a little bit.
+             * 
+             * @return false if the caller should stop busy-waiting and park
+             */
+            bool pause() noexcept {
+                if(iterations < spin_limit) {
+                    for(unsigned i = 0; i < (1u << (iterations / 16)); ++i) {
+                        cpu_relax();
+                    }
+                } else if(iterations < yield_limit) {
+                    std::this_thread::yield();
+                } else {
+                    return false;
+                }
+                ++iterations;
+                return true;
+            }
+
+            /**
+             * @brief Wait a little bit, never parks; for waits which can not block (eg. timed waits).
+             */
+            void pause_or_sleep() noexcept {
+                if(!pause()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+                }
+            }
+        private:
+            unsigned iterations = 0;
+        };
+
+        /**
+         * @brief Wait while `blocked(value of word)` holds; spins with `backoff`, then parks on `word`.
+         * Whoever modifies `word` in a way that may unblock a waiter must `notify_all()` it.
+         */
+        template<typename Word, typename Predicate>
+        void spin_wait(const std::atomic<Word> & word, Predicate blocked) noexcept {
+            backoff waiter;
+            for(auto current = word.load(std::memory_order_acquire); blocked(current); current = word.load(std::memory_order_acquire)) {
+                if(!waiter.pause()) {
+                    word.wait(current, std::memory_order_acquire);
+                }
+            }
+        }
+
+        /**
+         * An event count; lets a thread block until some condition, which is published through
+         * other atomics, might have changed, without making the notifying side pay for a wake-up
+         * when nobody waits.
+         *
+         * Waiters call `prepare_wait()`, re-check their condition, then either `cancel_wait()` or
+         * `wait(key)`. Notifiers publish their change first, then call `notify()`.
+         */
+        class event_count {
+        public:
+            std::uint32_t prepare_wait() noexcept {
+                waiters.fetch_add(1);
+                return epoch.load();
+            }
+
+            void cancel_wait() noexcept {
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void wait(std::uint32_t key) noexcept {
+                epoch.wait(key);
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void notify() noexcept {
+                // Orders the caller's publication before reading `waiters`; pairs with `prepare_wait()`.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(waiters.load(std::memory_order_relaxed) != 0) {
+                    epoch.fetch_add(1);
+                    epoch.notify_all();
+                }
+            }
+
+        private:
+            std::atomic<std::uint32_t> epoch = {0};
+            std::atomic<std::uint32_t> waiters = {0};
+        };
+
+        /**
+         * A small table of event counts owned by a lock, for waiters which must not be notified through
+         * their own memory (it may be gone as soon as they observe the change they wait for). Each waiter
+         * parks on the slot its address hashes to, so a notification only wakes the waiters of one slot,
+         * which is usually just the one it is meant for.
+         *
+         * @tparam SlotCount Amount of event counts
+         */
+        template<std::size_t SlotCount = 8>
+        class parking_table {
+            static_assert(SlotCount > 0);
+        public:
+            event_count & slot_of(const void * waiter) noexcept {
+                // Stacks of different threads differ in their high bits only, so mix before picking a slot.
+                const auto hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(waiter)) * 0x9E3779B97F4A7C15ull;
+                return slots[static_cast<std::size_t>(hash >> 32) % SlotCount];
+            }
+
+        private:
+            std::array<event_count, SlotCount> slots;
+        };
+    }
+
+    /**
+     * Preference tag; writers wait until there are no readers, new readers are admitted meanwhile.
+     */
+    struct reader_preference {};
+
+    /**
+     * Preference tag; waiting writers block new readers, so writers are not starved.
+     */
+    struct writer_preference {};
+
+    /**
+     * A reader-writer lock for short critical sections. Waiters spin (with `pause`/`yield` backoff) 
+     * before parking on `std::atomic::wait`, so waits shorter than a context switch never enter the kernel,
+     * and unlocking only notifies when a waiter is actually parked.
+     * 
+     * The whole lock is a single 32-bit word;
+     * 
+     * - bit 31      : exclusive owner
+     * - bit 30      : some waiter is parked
+     * - bits 20..29 : amount of waiting writers (writers preference only)
+     * - bits 0..19  : amount of shared owners
+     * 
+     * @tparam Preference `writer_preference` or `reader_preference`
+     */
+    template<typename Preference = writer_preference>
+    class spin_shared_mutex : private noncopyable {
+        static constexpr bool prefer_writers = std::is_same_v<Preference, writer_preference>;
+    public:
+        spin_shared_mutex() = default;
+
+        void lock() noexcept {
+            if(try_lock()) {
+                return;
+            }
+            announce_writer();
+            detail::backoff waiter;
+            for(auto current = state.load(std::memory_order_relaxed);;) {
+                if(!(current & (writer | readers_mask))) {
+                    if(state.compare_exchange_weak(current, (current - announced_writer()) | writer, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+                if(!waiter.pause()) {
+                    park(current);
+                }
+                current = state.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool try_lock() noexcept {
+            auto expected = std::uint32_t{0};
+            return state.compare_exchange_strong(expected, writer, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        template<typename Rep, typename Period>
+        bool try_lock_for(const std::chrono::duration<Rep, Period> & duration) {
+            return try_lock_until(std::chrono::steady_clock::now() + duration);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_lock_until(const std::chrono::time_point<Clock, Duration> & time_point) {
+            if(try_lock()) {
+                return true;
+            }
+            announce_writer();
+            detail::backoff waiter;
+            for(auto current = state.load(std::memory_order_relaxed);;) {
+                if(!(current & (writer | readers_mask))) {
+                    if(state.compare_exchange_weak(current, (current - announced_writer()) | writer, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return true;
+                    }
+                    continue;
+                }
+                if(Clock::now() >= time_point) {
+                    withdraw_writer();
+                    return false;
+                }
+                waiter.pause_or_sleep();
+                current = state.load(std::memory_order_relaxed);
+            }
+        }
+
+        void unlock() noexcept {
+            const auto previous = state.fetch_and(~(writer | parked), std::memory_order_release);
+            if(previous & parked) {
+                state.notify_all();
+            }
+        }
+
+        void lock_shared() noexcept {
+            detail::backoff waiter;
+            for(auto current = state.load(std::memory_order_relaxed);;) {
+                if(can_enter_shared(current)) {
+                    if(state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                        return;
+                    }
+                    continue;
+                }
+                if(!waiter.pause()) {
+                    park(current);
+                }
+                current = state.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool try_lock_shared() noexcept {
+            auto current = state.load(std::memory_order_relaxed);
+            while(can_enter_shared(current)) {
+                if(state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template<typename Rep, typename Period>
+        bool try_lock_shared_for(const std::chrono::duration<Rep, Period> & duration) {
+            return try_lock_shared_until(std::chrono::steady_clock::now() + duration);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> & time_point) {
+            detail::backoff waiter;
+            while(!try_lock_shared()) {
+                if(Clock::now() >= time_point) {
+                    return false;
+                }
+                waiter.pause_or_sleep();
+            }
+            return true;
+        }
+
+        void unlock_shared() noexcept {
+            const auto previous = state.fetch_sub(1, std::memory_order_release);
+            // Only the last reader can let a waiter in.
+            if((previous & readers_mask) == 1 && (previous & parked)) {
+                state.fetch_and(~parked, std::memory_order_relaxed);
+                state.notify_all();
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t writer = 1u << 31;
+        static constexpr std::uint32_t parked = 1u << 30;
+        static constexpr std::uint32_t waiting_writer = 1u << 20;
+        static constexpr std::uint32_t waiting_writers_mask = ((1u << 10) - 1) << 20;
+        static constexpr std::uint32_t readers_mask = waiting_writer - 1;
+
+        static constexpr std::uint32_t announced_writer() noexcept { return prefer_writers ? waiting_writer : 0; }
+
+        static bool can_enter_shared(std::uint32_t current) noexcept {
+            const auto blocked = prefer_writers ? (writer | waiting_writers_mask) : writer;
+            return !(current & blocked) && (current & readers_mask) != readers_mask;
+        }
+
+        void announce_writer() noexcept {
+            if constexpr (prefer_writers) {
+                state.fetch_add(waiting_writer, std::memory_order_relaxed);
+            }
+        }
+
+        void withdraw_writer() noexcept {
+            if constexpr (prefer_writers) {
+                const auto previous = state.fetch_sub(waiting_writer, std::memory_order_relaxed);
+                // Readers might be parked because of us.
+                if(previous & parked) {
+                    state.fetch_and(~parked, std::memory_order_relaxed);
+                    state.notify_all();
+                }
+            }
+        }
+
+        /**
+         * @brief Block until the lock word changes from `current`, after flagging that a waiter is parked.
+         */
+        void park(std::uint32_t current) noexcept {
+            if(!(current & parked) && !state.compare_exchange_strong(current, current | parked, std::memory_order_relaxed)) {
+                return;
+            }
+            state.wait(current | parked, std::memory_order_relaxed);
+        }
+
+        std::atomic<std::uint32_t> state = {0};
+    };
+
+    static_assert(shared_timed_lockable<spin_shared_mutex<>> && timed_lockable<spin_shared_mutex<>>);
+    static_assert(shared_timed_lockable<spin_shared_mutex<reader_preference>> && timed_lockable<spin_shared_mutex<reader_preference>>);
+}
@@ -0,0 +1,182 @@
+/**
+ * ______________________________________________________
+ * Upgradeable shared mutex, built on STL primitives.
+ * 
+ * @file 	lockable_upgrade.hpp
+ * @author 	Mustafa Kemal GILOR <mgilor@nettsi.com>
+ * @date 	02.12.2020
+ * 
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#pragma once
+
+#include "concurrent.hpp"
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <climits>
+
+namespace mkg {
+
+    /**
+     * A shared mutex which additionally supports upgrade locking (see `upgradeable_lockable`), the STL
+     * counterpart of boost::upgrade_mutex.
+     * 
+     * Uses the two-gate design; a writer (or upgrader) which enters the first gate blocks new readers, 
+     * then waits at the second gate for the existing readers to leave, so writers are not starved.
+     */
+    class upgrade_mutex : private noncopyable {
+    public:
+        upgrade_mutex() = default;
+
+        void lock() {
+            std::unique_lock<std::mutex> guard{ state_mutex };
+            gate1.wait(guard, [this] { return !(state & (write_entered | upgrade_entered)); });
+            state |= write_entered;
+            gate2.wait(guard, [this] { return !(state & readers_mask); });
+        }
+
+        bool try_lock() {
+            std::lock_guard<std::mutex> guard{ state_mutex };
+            if(state == 0) {
+                state = write_entered;
+                return true;
+            }
+            return false;
+        }
+
+        template<typename Rep, typename Period>
+        bool try_lock_for(const std::chrono::duration<Rep, Period> & duration) {
+            return try_lock_until(std::chrono::steady_clock::now() + duration);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_lock_until(const std::chrono::time_point<Clock, Duration> & time_point) {
+            std::unique_lock<std::mutex> guard{ state_mutex };
+            if(!gate1.wait_until(guard, time_point, [this] { return !(state & (write_entered | upgrade_entered)); })) {
+                return false;
+            }
+            state |= write_entered;
+            if(!gate2.wait_until(guard, time_point, [this] { return !(state & readers_mask); })) {
+                state &= ~write_entered;
+                guard.unlock();
+                gate1.notify_all();
+                return false;
+            }
+            return true;
+        }
+
+        void unlock() {
+            {
+                std::lock_guard<std::mutex> guard{ state_mutex };
+                state = 0;
+            }
+            gate1.notify_all();
+        }
+
+        void lock_shared() {
+            std::unique_lock<std::mutex> guard{ state_mutex };
+            gate1.wait(guard, [this] { return can_enter_shared(); });
+            ++state;
+        }
+
+        bool try_lock_shared() {
+            std::lock_guard<std::mutex> guard{ state_mutex };
+            return can_enter_shared() ? (++state, true) : false;
+        }
+
+        template<typename Rep, typename Period>
+        bool try_lock_shared_for(const std::chrono::duration<Rep, Period> & duration) {
+            return try_lock_shared_until(std::chrono::steady_clock::now() + duration);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> & time_point) {
+            std::unique_lock<std::mutex> guard{ state_mutex };
+            if(!gate1.wait_until(guard, time_point, [this] { return can_enter_shared(); })) {
+                return false;
+            }
+            ++state;
+            return true;
+        }
+
+        void unlock_shared() {
+            std::lock_guard<std::mutex> guard{ state_mutex };
+            const auto readers = (state & readers_mask) - 1;
+            state = (state & ~readers_mask) | readers;
+            if(state & write_entered) {
+                // A writer (or upgrader) waits at the second gate for the last reader.
+                if(readers == 0) {
+                    gate2.notify_one();
+                }
+            } else if(readers == readers_mask - 1) {
+                gate1.notify_one();
+            }
+        }
+
+        /**
+         * @brief Acquire the upgrade lock; it counts as a shared lock, but excludes other upgraders and writers.
+         */
+        void lock_upgrade() {
+            std::unique_lock<std::mutex> guard{ state_mutex };
+            gate1.wait(guard, [this] { return !(state & upgrade_entered) && can_enter_shared(); });
+            state = (state + 1) | upgrade_entered;
+        }
+
+        bool try_lock_upgrade() {
+            std::lock_guard<std::mutex> guard{ state_mutex };
+            if(!(state & upgrade_entered) && can_enter_shared()) {
+                state = (state + 1) | upgrade_entered;
+                return true;
+            }
+            return false;
+        }
+
+        void unlock_upgrade() {
+            {
+                std::lock_guard<std::mutex> guard{ state_mutex };
+                state = (state & ~upgrade_entered) - 1;
+            }
+            gate1.notify_all();
+        }
+
+        /**
+         * @brief Atomically convert the upgrade lock held by the caller into an exclusive lock.
+         */
+        void unlock_upgrade_and_lock() {
+            std::unique_lock<std::mutex> guard{ state_mutex };
+            state = ((state & ~upgrade_entered) - 1) | write_entered;
+            gate2.wait(guard, [this] { return !(state & readers_mask); });
+        }
+
+        /**
+         * @brief Atomically convert the exclusive lock held by the caller into an upgrade lock.
+         */
+        void unlock_and_lock_upgrade() {
+            {
+                std::lock_guard<std::mutex> guard{ state_mutex };
+                state = upgrade_entered | 1;
+            }
+            gate1.notify_all();
+        }
+
+    private:
+        static constexpr unsigned write_entered = 1u << (sizeof(unsigned) * CHAR_BIT - 1);
+        static constexpr unsigned upgrade_entered = write_entered >> 1;
+        static constexpr unsigned readers_mask = ~(write_entered | upgrade_entered);
+
+        bool can_enter_shared() const noexcept {
+            return !(state & write_entered) && (state & readers_mask) != readers_mask;
+        }
+
+        std::mutex state_mutex;
+        std::condition_variable gate1;
+        std::condition_variable gate2;
+        unsigned state = 0;
+    };
+
+    static_assert(shared_timed_lockable<upgrade_mutex> && timed_lockable<upgrade_mutex> && upgradeable_lockable<upgrade_mutex>);
+}
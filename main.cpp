@@ -21,8 +21,12 @@
 #include <chrono>       // std::chrono
 
 
-//#include "concurrent_stl.hpp" // use stl lock primitives as backend
-#include "concurrent_boost.hpp" // use stl lock primitives as backend
+#if defined(CONCURRENT_EXAMPLE_USE_STL)
+#include "concurrent_stl.hpp" // use stl lock primitives as backend
+#else
+#include "concurrent_boost.hpp" // use boost lock primitives as backend
+#endif
+#include "lockable_upgrade.hpp" // upgradeable shared mutex (mkg::upgrade_mutex)
 
 using namespace mkg;
 
@@ -79,6 +83,25 @@ int main(void){
         }
     }
 
+    {
+        // Split a map into independently locked shards, so writers of different keys do not contend.
+        sharded_concurrent<std::map<std::string, std::uint64_t>> sharded_map;
+        {
+            // Only the shard which owns the key "First" is locked.
+            auto write_accessor = sharded_map.write_access_handle("First");
+            write_accessor->emplace("First", 1);
+        }
+        {
+            // Lock all shards (in a fixed order) to iterate over the whole map.
+            auto read_accessors = sharded_map.read_access_handle_all();
+            for(auto & shard : read_accessors){
+                for(const auto & pair : (*shard)){
+                    std::cout << pair.first << ":" << pair.second << std::endl;
+                }
+            }
+        }
+    }
+
     {
         concurrent<std::string> concurrent_string;
         {
@@ -123,45 +146,85 @@ int main(void){
         }
     }
 
+    {
+        // Read-copy-update: readers never block, writers publish a modified copy.
+        concurrent<rcu<std::map<std::string, std::string>>> routes;
+        {
+            auto write_accessor = routes.write_access_handle();
+            write_accessor->emplace("/", "index.html");
+        }
+        auto read_accessor = routes.read_access_handle();
+        std::cout << read_accessor->at("/") << std::endl;
+    }
 
     {
-        concurrent<std::map<std::string,std::string>> shared_resource;
+        // Types which fit a lock-free std::atomic can be backed by one, there is no lock at all.
+        concurrent<lock_free<float>> coefficient{0.1f};
+        coefficient.write([](float & value) { value *= 2; });
+        auto read_accessor = coefficient.read_access_handle();
+        std::cout << (*read_accessor) << std::endl;
+
+        concurrent<lock_free<std::uint64_t>> counter;
+        counter.fetch_add(1);
+        std::cout << counter.load() << std::endl;
+    }
+
+    {
+        // Small trivially copyable types can be backed by a seqlock; readers take lock-free snapshots.
+        struct range { float low, high, step; };
+        concurrent<seqlocked<range>> bounds{range{0.f, 1.f, 0.1f}};
+        {
+            auto write_accessor = bounds.write_access_handle();
+            write_accessor->high = 2.f;
+        }
+        auto read_accessor = bounds.read_access_handle();
+        std::cout << read_accessor->high << std::endl;
+    }
+
+
+    {
+        // Upgradeable lockable, so consumers can check-then-erase without releasing the lock in between.
+        concurrent<std::map<std::string,std::string>, upgrade_mutex> shared_resource;
         std::vector<std::thread> producer_threads, consumer_threads;
+        constexpr std::uint64_t item_count = 8;
         static std::atomic<std::uint64_t> idx = {0};
+        static std::atomic<std::uint64_t> consumed = {0};
         {         
             // spawn producers
             producer_threads.emplace_back(std::thread(
                 [&shared_resource](){                       
-                    for(;;){
+                    for(std::uint64_t i = 0; i < item_count; ++i){
                         {
                             auto write_accessor = shared_resource.write_access_handle();
                             write_accessor->emplace(std::to_string(idx++), "foo");
                         }
-                        std::this_thread::sleep_for(std::chrono::milliseconds(750));
+                        std::this_thread::sleep_for(std::chrono::milliseconds(20));
                     }      
                 }
             ));
         }
 
         {
-            // spawn consumers
+            // spawn consumers, which stop once every produced item is consumed
             consumer_threads.emplace_back(std::thread(
                 [&shared_resource](){
                     
-                    for(;;){
+                    while(consumed.load() < item_count){
                         {
-                            auto read_accessor = shared_resource.read_access_handle();
-                            for(const auto & pair : (*read_accessor)){
+                            // Readers are still allowed while we hold the upgradeable accessor.
+                            auto upgradeable_accessor = shared_resource.upgrade_access_handle();
+                            for(const auto & pair : (*upgradeable_accessor)){
                                 std::cout << pair.first << ":" << pair.second << std::endl;                      
                             }
                             std::flush(std::cout);
-                        }
-                        {
-                            auto write_accessor = shared_resource.write_access_handle();
-                            if(!write_accessor->empty())
+                            if(!upgradeable_accessor->empty()){
+                                // Upgrade in place; nobody could have modified the map in between.
+                                auto write_accessor = upgradeable_accessor.upgrade();
                                 write_accessor->erase(write_accessor->begin());
+                                ++consumed;
+                            }
                         }
-                        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
                     }
                 }
             ));
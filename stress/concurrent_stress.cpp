@@ -0,0 +1,892 @@
+/**
+ * ______________________________________________________
+ * Scalability stress harness and contention profiler for the concurrent wrapper and its lock backends.
+ *
+ * Runs a fixed-duration workload per backend and thread count, and reports throughput, latency
+ * percentiles and per-thread fairness, as text or as JSON (to diff between releases), eg.
+ *
+ * concurrent_stress --backend=std::shared_mutex,mcs_shared_mutex --threads=1,4,16 --mix=95:5 \
+ *     --distribution=zipf --duration-ms=2000 --json=results.json
+ *
+ * @file 	concurrent_stress.cpp
+ * @author 	Mustafa Kemal GILOR <mustafagilor@gmail.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+#include <algorithm>    // std::max, std::min, std::find_if
+#include <array>        // std::array
+#include <atomic>       // std::atomic
+#include <bit>          // std::bit_width
+#include <chrono>       // std::chrono
+#include <cmath>        // std::pow
+#include <concepts>     // std::same_as
+#include <cstdint>      // std::uint64_t
+#include <cstdio>       // std::FILE, std::fprintf
+#include <deque>        // std::deque
+#include <functional>   // std::function
+#include <iostream>     // std::cout, std::cerr
+#include <map>          // std::map
+#include <memory>       // std::unique_ptr
+#include <optional>     // std::optional
+#include <sstream>      // std::ostringstream
+#include <stdexcept>    // std::invalid_argument
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <thread>       // std::thread
+#include <vector>       // std::vector
+
+#include "concurrent_stl.hpp"
+#include "concurrent_queue.hpp"
+#include "buffered_writer.hpp"
+#include "arena.hpp"
+#include "lockable_spin.hpp"
+#include "lockable_distributed.hpp"
+#include "lockable_combining.hpp"
+#include "lockable_elision.hpp"
+#include "lockable_compact.hpp"
+#include "lockable_fair.hpp"
+#include "lockable_cohort.hpp"
+#include "lockable_mcs.hpp"
+#include "lockable_upgrade.hpp"
+#include "lockable_reentrant.hpp"
+
+#if defined(CONCURRENT_STRESS_WITH_BOOST)
+#include <boost/thread/shared_mutex.hpp>
+#endif
+
+using namespace mkg;
+
+namespace {
+
+    using clock_type = std::chrono::steady_clock;
+    using map_t = std::map<std::uint64_t, std::uint64_t>;
+    using pmr_map_t = std::pmr::map<std::uint64_t, std::uint64_t>;
+
+    enum class distribution { uniform, zipf };
+
+    /**
+     * Parameters of a run; every run uses one backend and one thread count.
+     */
+    struct options {
+        std::vector<std::string> backends = { "std::shared_mutex" };
+        std::vector<std::size_t> thread_counts = { 1, 2, 4, 8 };
+        /// Percentage of write operations (the rest are reads)
+        std::uint64_t write_percentage = 5;
+        distribution keys_distribution = distribution::uniform;
+        double zipf_theta = 0.99;
+        std::uint64_t key_count = 4096;
+        std::chrono::milliseconds duration{ 1000 };
+        std::chrono::milliseconds warmup{ 100 };
+        /// Every n-th operation of a thread is timed; reading the clock costs about as much as an uncontended lock.
+        std::uint64_t latency_sample_interval = 8;
+        std::optional<std::string> json_path;
+    };
+
+    /**
+     * Cheap per-thread pseudo random number generator (xorshift64).
+     */
+    struct xorshift {
+        std::uint64_t state;
+        std::uint64_t operator()() noexcept {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        /**
+         * @brief Uniformly distributed in [0, 1).
+         */
+        double unit() noexcept { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+    };
+
+    /**
+     * Key generator; Zipfian keys are drawn as in YCSB (Gray et al., "Quickly generating billion-record synthetic
+     * databases"), so key 0 is the hottest one.
+     */
+    class key_generator {
+    public:
+        key_generator(const options & opts, std::uint64_t seed) :
+            random{ seed }, count{ std::max<std::uint64_t>(opts.key_count, 1) }, zipf{ opts.keys_distribution == distribution::zipf } {
+            if(zipf) {
+                theta = opts.zipf_theta;
+                zeta_n = zeta(count, theta);
+                alpha = 1.0 / (1.0 - theta);
+                eta = (1.0 - std::pow(2.0 / static_cast<double>(count), 1.0 - theta)) / (1.0 - zeta(2, theta) / zeta_n);
+            }
+        }
+
+        std::uint64_t operator()() noexcept {
+            if(!zipf) {
+                return random() % count;
+            }
+            const double u = random.unit();
+            const double uz = u * zeta_n;
+            if(uz < 1.0) {
+                return 0;
+            }
+            if(uz < 1.0 + std::pow(0.5, theta)) {
+                return 1;
+            }
+            return std::min(count - 1, static_cast<std::uint64_t>(static_cast<double>(count) * std::pow(eta * u - eta + 1.0, alpha)));
+        }
+
+        xorshift random;
+
+    private:
+        static double zeta(std::uint64_t n, double theta) noexcept {
+            double sum = 0;
+            for(std::uint64_t i = 1; i <= n; ++i) {
+                sum += 1.0 / std::pow(static_cast<double>(i), theta);
+            }
+            return sum;
+        }
+
+        std::uint64_t count;
+        bool zipf;
+        double theta = 0, zeta_n = 0, alpha = 0, eta = 0;
+    };
+
+    /**
+     * Log-linear latency histogram (16 linear sub-buckets per power of two, <= 6.25% error), in nanoseconds.
+     */
+    class latency_histogram {
+    public:
+        void record(std::uint64_t nanoseconds) noexcept {
+            ++buckets[index_of(nanoseconds)];
+            ++samples;
+            max = std::max(max, nanoseconds);
+        }
+
+        void merge(const latency_histogram & other) noexcept {
+            for(std::size_t i = 0; i < bucket_count; ++i) {
+                buckets[i] += other.buckets[i];
+            }
+            samples += other.samples;
+            max = std::max(max, other.max);
+        }
+
+        /**
+         * @brief Upper bound of the bucket which holds the `quantile` (in [0, 1]) of the samples.
+         */
+        std::uint64_t percentile(double quantile) const noexcept {
+            if(samples == 0) {
+                return 0;
+            }
+            const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(quantile * static_cast<double>(samples) + 0.5));
+            std::uint64_t seen = 0;
+            for(std::size_t i = 0; i < bucket_count; ++i) {
+                seen += buckets[i];
+                if(seen >= rank) {
+                    return std::min(max, upper_bound_of(i));
+                }
+            }
+            return max;
+        }
+
+        std::uint64_t sample_count() const noexcept { return samples; }
+        std::uint64_t maximum() const noexcept { return max; }
+
+    private:
+        static constexpr std::size_t sub_buckets = 16;
+        static constexpr std::size_t bucket_count = 61 * sub_buckets;
+
+        static std::size_t index_of(std::uint64_t value) noexcept {
+            if(value < sub_buckets) {
+                return static_cast<std::size_t>(value);
+            }
+            const auto magnitude = static_cast<std::size_t>(std::bit_width(value)) - 1;
+            const auto group = magnitude - 3;
+            return group * sub_buckets + static_cast<std::size_t>((value >> (magnitude - 4)) & (sub_buckets - 1));
+        }
+
+        static std::uint64_t upper_bound_of(std::size_t index) noexcept {
+            const auto group = index / sub_buckets, sub = index % sub_buckets;
+            if(group == 0) {
+                return sub;
+            }
+            return ((sub_buckets + sub + 1) << (group - 1)) - 1;
+        }
+
+        std::array<std::uint64_t, bucket_count> buckets = {};
+        std::uint64_t samples = 0;
+        std::uint64_t max = 0;
+    };
+
+    /**
+     * Measurements of a single worker thread; each on its own cache line.
+     */
+    struct alignas(cache_line_size) thread_result {
+        std::uint64_t reads = 0;
+        std::uint64_t writes = 0;
+        latency_histogram read_latency;
+        latency_histogram write_latency;
+    };
+
+    struct run_result {
+        std::string backend;
+        std::string workload;
+        std::size_t threads = 0;
+        std::chrono::nanoseconds elapsed{};
+        std::vector<thread_result> per_thread;
+        std::optional<lock_metrics> metrics;
+    };
+
+    /*
+     * Targets: a target owns the resource under test, and hands out a `session` per worker thread, whose
+     * `read(key)` and `write(key)` are the measured operations. Map targets look a key up, and increment
+     * it; queue targets pop and push.
+     */
+
+    /**
+     * A `concurrent` map, accessed through `read(fn)` and `write(fn)`.
+     */
+    template<typename ConcurrentType>
+    struct map_target {
+        static constexpr std::string_view workload = "map";
+
+        template<typename... Args>
+        explicit map_target(const options & opts, Args &&... resource_args) : resource{ std::forward<Args>(resource_args)... } {
+            resource.write([&](auto & map) {
+                for(std::uint64_t key = 0; key < opts.key_count; ++key) {
+                    map.emplace(key, 0);
+                }
+            });
+        }
+
+        struct session {
+            ConcurrentType & resource;
+
+            std::uint64_t read(std::uint64_t key) {
+                return resource.read([key](const auto & map) {
+                    const auto it = map.find(key);
+                    return it == map.end() ? 0 : it->second;
+                });
+            }
+
+            void write(std::uint64_t key) {
+                resource.write([key](auto & map) { ++map[key]; });
+            }
+        };
+
+        session open() { return { resource }; }
+
+        std::optional<lock_metrics> metrics() const {
+            std::optional<lock_metrics> result;
+            if constexpr (requires { resource.export_metrics([](const lock_metrics &) {}); }) {
+                resource.export_metrics([&](const lock_metrics & current) { result = current; });
+            }
+            return result;
+        }
+
+        ConcurrentType resource;
+    };
+
+    struct arena_holder {
+        arena map_arena;
+    };
+
+    /**
+     * A map whose nodes are allocated from an arena of its own; the arena (a base class) outlives the map.
+     */
+    struct arena_map_target : private arena_holder, map_target<concurrent<pmr_map_t, std::shared_mutex>> {
+        explicit arena_map_target(const options & opts) :
+            map_target{ opts, std::allocator_arg, static_cast<std::pmr::memory_resource *>(&map_arena) } {}
+    };
+
+    /**
+     * A `sharded_concurrent` map; only the shard of the key is locked.
+     */
+    template<typename ShardedType>
+    struct sharded_target {
+        static constexpr std::string_view workload = "map";
+
+        explicit sharded_target(const options & opts) {
+            for(std::uint64_t key = 0; key < opts.key_count; ++key) {
+                resource.write_access_handle(key)->emplace(key, 0);
+            }
+        }
+
+        struct session {
+            ShardedType & resource;
+
+            std::uint64_t read(std::uint64_t key) {
+                auto accessor = resource.read_access_handle(key);
+                const auto it = accessor->find(key);
+                return it == accessor->end() ? 0 : it->second;
+            }
+
+            void write(std::uint64_t key) {
+                ++(*resource.write_access_handle(key))[key];
+            }
+        };
+
+        session open() { return { resource }; }
+        std::optional<lock_metrics> metrics() const { return std::nullopt; }
+
+        ShardedType resource;
+    };
+
+    /**
+     * A `striped_concurrent` vector of counters, indexed by key; only the stripe of the key is locked.
+     */
+    template<typename StripedType>
+    struct striped_target {
+        static constexpr std::string_view workload = "map";
+
+        explicit striped_target(const options & opts) : resource{ std::vector<std::uint64_t>(std::max<std::uint64_t>(opts.key_count, 1)) } {}
+
+        struct session {
+            StripedType & resource;
+            std::uint64_t read(std::uint64_t key) { return *resource.read_access_handle(key); }
+            void write(std::uint64_t key) { ++(*resource.write_access_handle(key)); }
+        };
+
+        session open() { return { resource }; }
+        std::optional<lock_metrics> metrics() const { return std::nullopt; }
+
+        StripedType resource;
+    };
+
+    /**
+     * Writes go through a `buffered_writer`; reads go to the resource directly (so they may miss the
+     * writes which are still buffered), since reading through the writer flushes every buffer.
+     */
+    struct buffered_target : map_target<concurrent<map_t, std::shared_mutex>> {
+        using map_target::map_target;
+
+        struct session {
+            buffered_target & target;
+            std::uint64_t read(std::uint64_t key) { return map_target::session{ target.resource }.read(key); }
+            void write(std::uint64_t key) { target.writer.write([key](map_t & map) { ++map[key]; }); }
+        };
+
+        session open() { return { *this }; }
+
+        buffered_writer<concurrent<map_t, std::shared_mutex>> writer{ resource };
+    };
+
+    /**
+     * Reads go through a per-thread `read_cache`, which copies the map whenever it has changed.
+     */
+    struct cached_target : map_target<concurrent<map_t, versioned<std::shared_mutex>>> {
+        using map_target::map_target;
+
+        struct session {
+            concurrent<map_t, versioned<std::shared_mutex>> & resource;
+            read_cache<concurrent<map_t, versioned<std::shared_mutex>>> cache{ resource };
+
+            std::uint64_t read(std::uint64_t key) {
+                const auto & map = cache.cached_read();
+                const auto it = map.find(key);
+                return it == map.end() ? 0 : it->second;
+            }
+
+            void write(std::uint64_t key) {
+                resource.write([key](auto & map) { ++map[key]; });
+            }
+        };
+
+        session open() { return { resource }; }
+    };
+
+    /**
+     * A queue of keys; writes push a key, reads pop one (if any).
+     */
+    template<typename QueueType>
+    struct queue_target {
+        static constexpr std::string_view workload = "queue";
+
+        explicit queue_target(const options &) {}
+
+        struct session {
+            QueueType & queue;
+            std::uint64_t read(std::uint64_t) { return queue.try_pop().value_or(0); }
+            void write(std::uint64_t key) { static_cast<void>(queue.try_push(key)); }
+        };
+
+        session open() { return { queue }; }
+        std::optional<lock_metrics> metrics() const { return std::nullopt; }
+
+        QueueType queue;
+    };
+
+    /**
+     * A `std::deque` behind a `concurrent`, with the interface of the queues.
+     */
+    struct locked_deque {
+        bool try_push(std::uint64_t value) {
+            queue.write([value](auto & q) { q.push_back(value); });
+            return true;
+        }
+
+        std::optional<std::uint64_t> try_pop() {
+            return queue.write([](auto & q) -> std::optional<std::uint64_t> {
+                if(q.empty()) {
+                    return std::nullopt;
+                }
+                const auto value = q.front();
+                q.pop_front();
+                return value;
+            });
+        }
+
+        concurrent<std::deque<std::uint64_t>> queue;
+    };
+
+    struct bounded_queue : bounded_concurrent_queue<std::uint64_t> {
+        bounded_queue() : bounded_concurrent_queue{ 1024 } {}
+    };
+
+    /**
+     * A small trivially copyable record, which the seqlock backend can protect.
+     */
+    struct sample {
+        std::uint64_t last_key = 0;
+        std::uint64_t hits = 0;
+        double weight = 1.0;
+    };
+
+    inline std::uint64_t hits_of(const sample & value) noexcept { return value.hits; }
+    inline std::uint64_t hits_of(std::uint64_t value) noexcept { return value; }
+
+    inline void record(sample & value, std::uint64_t key) noexcept {
+        value.last_key = key;
+        ++value.hits;
+        value.weight *= 0.5;
+    }
+
+    inline void record(std::uint64_t & value, std::uint64_t) noexcept { ++value; }
+
+    /**
+     * A single trivially copyable value (a `sample`, or a counter); reads copy it, and writes update it.
+     * Exercises the seqlock (`seqlocked<T>`) and atomic (`lock_free<T>`) backends, against a lock.
+     */
+    template<typename ConcurrentType>
+    struct value_target {
+        using value_type = typename ConcurrentType::value_type;
+        static constexpr std::string_view workload = std::same_as<value_type, sample> ? "payload" : "counter";
+
+        explicit value_target(const options &) {}
+
+        struct session {
+            ConcurrentType & resource;
+
+            std::uint64_t read(std::uint64_t) {
+                return resource.read([](const value_type & value) { return hits_of(value); });
+            }
+
+            void write(std::uint64_t key) {
+                if constexpr (requires { resource.fetch_add(1); }) {
+                    resource.fetch_add(1);
+                } else {
+                    resource.write([key](value_type & value) { record(value, key); });
+                }
+            }
+        };
+
+        session open() { return { resource }; }
+        std::optional<lock_metrics> metrics() const { return std::nullopt; }
+
+        ConcurrentType resource;
+    };
+
+    /**
+     * @brief Run `opts.warmup`, then `opts.duration` of the workload on `thread_count` threads, against a fresh `Target`.
+     */
+    template<typename Target>
+    run_result run(const std::string & backend, const options & opts, std::size_t thread_count) {
+        enum phase : int { warmup, measure, stop };
+
+        auto target = std::make_unique<Target>(opts);
+        std::vector<thread_result> results(thread_count);
+        std::atomic<std::size_t> ready = { 0 };
+        std::atomic<int> current_phase = { warmup };
+        std::atomic<bool> go = { false };
+
+        const auto worker = [&](std::size_t index) {
+            key_generator keys{ opts, 0x9E3779B97F4A7C15ull * (index + 1) };
+            auto session = target->open();
+            auto & result = results[index];
+            std::uint64_t counter = 0, checksum = 0;
+            ready.fetch_add(1);
+            while(!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for(int observed = warmup; observed != stop; ++counter) {
+                if(counter % 64 == 0) {
+                    observed = current_phase.load(std::memory_order_relaxed);
+                }
+                const auto key = keys();
+                const bool is_write = keys.random() % 100 < opts.write_percentage;
+                const bool timed = observed == measure && counter % opts.latency_sample_interval == 0;
+                const auto start = timed ? clock_type::now() : clock_type::time_point{};
+                if(is_write) {
+                    session.write(key);
+                } else {
+                    checksum += session.read(key);
+                }
+                if(observed != measure) {
+                    continue;
+                }
+                if(timed) {
+                    const auto latency = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+                    (is_write ? result.write_latency : result.read_latency).record(latency);
+                }
+                ++(is_write ? result.writes : result.reads);
+            }
+            // Keep the reads from being optimized away.
+            static std::atomic<std::uint64_t> sink;
+            sink.fetch_add(checksum, std::memory_order_relaxed);
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for(std::size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back(worker, i);
+        }
+        while(ready.load() != thread_count) {
+            std::this_thread::yield();
+        }
+        go.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(opts.warmup);
+        const auto begin = clock_type::now();
+        current_phase.store(measure, std::memory_order_relaxed);
+        std::this_thread::sleep_for(opts.duration);
+        current_phase.store(stop, std::memory_order_relaxed);
+        const auto end = clock_type::now();
+        for(auto & thread : threads) {
+            thread.join();
+        }
+
+        run_result result{ backend, std::string{ Target::workload }, thread_count, end - begin, std::move(results), target->metrics() };
+        return result;
+    }
+
+    using runner = std::function<run_result(const std::string &, const options &, std::size_t)>;
+
+    /**
+     * Backends, in registration order.
+     */
+    std::vector<std::pair<std::string, runner>> & backends() {
+        static std::vector<std::pair<std::string, runner>> registered;
+        return registered;
+    }
+
+    template<typename Target>
+    void register_target(const std::string & name) {
+        backends().emplace_back(name, &run<Target>);
+    }
+
+    /**
+     * @brief Registers a `concurrent` map protected by `LockableType`.
+     */
+    template<typename LockableType>
+    void register_lockable(const std::string & name) {
+        register_target<map_target<concurrent<map_t, LockableType>>>(name);
+    }
+
+    void register_backends() {
+        register_lockable<std::shared_mutex>("std::shared_mutex");
+        register_lockable<cache_aligned<std::shared_mutex>>("cache_aligned<std::shared_mutex>");
+        register_lockable<instrumented<std::shared_mutex>>("instrumented<std::shared_mutex>");
+#if defined(CONCURRENT_STRESS_WITH_BOOST)
+        register_target<map_target<concurrent<map_t, boost::shared_mutex, boost::shared_lock, boost::unique_lock>>>("boost::shared_mutex");
+#endif
+        register_lockable<spin_shared_mutex<writer_preference>>("spin_shared_mutex<writer_preference>");
+        register_lockable<spin_shared_mutex<reader_preference>>("spin_shared_mutex<reader_preference>");
+        register_lockable<distributed_shared_mutex<>>("distributed_shared_mutex");
+        register_lockable<elided<std::shared_mutex>>("elided<std::shared_mutex>");
+        register_lockable<compact_shared_mutex>("compact_shared_mutex");
+        register_lockable<fair_shared_mutex<fairness::phase_fair>>("phase_fair_shared_mutex");
+        register_lockable<fair_shared_mutex<fairness::fifo>>("ticket_shared_mutex");
+        register_lockable<cohort_shared_mutex<>>("cohort_shared_mutex");
+        register_lockable<mcs_shared_mutex>("mcs_shared_mutex");
+        register_lockable<upgrade_mutex>("upgrade_mutex");
+        register_lockable<reentrant<std::shared_mutex>>("reentrant<std::shared_mutex>");
+        register_lockable<flat_combining<std::shared_mutex>>("flat_combining<std::shared_mutex>");
+        register_target<map_target<concurrent<rcu<map_t>>>>("rcu");
+        register_target<sharded_target<sharded_concurrent<map_t>>>("sharded_concurrent");
+        register_target<striped_target<striped_concurrent<std::vector<std::uint64_t>>>>("striped_concurrent");
+        register_target<buffered_target>("buffered_writer");
+        register_target<cached_target>("read_cache");
+        register_target<arena_map_target>("arena");
+        register_target<queue_target<locked_deque>>("queue:concurrent<std::deque>");
+        register_target<queue_target<concurrent_queue<std::uint64_t>>>("queue:concurrent_queue");
+        register_target<queue_target<bounded_queue>>("queue:bounded_concurrent_queue");
+        register_target<value_target<concurrent<sample, std::shared_mutex>>>("payload:std::shared_mutex");
+        register_target<value_target<concurrent<seqlocked<sample>>>>("payload:seqlocked");
+        register_target<value_target<concurrent<std::uint64_t, std::shared_mutex>>>("counter:std::shared_mutex");
+        register_target<value_target<concurrent<lock_free<std::uint64_t>>>>("counter:lock_free");
+    }
+
+    /*
+     * Reporting
+     */
+
+    struct summary {
+        std::uint64_t operations = 0;
+        double operations_per_second = 0;
+        latency_histogram read_latency, write_latency, latency;
+        /// Jain's fairness index of the per-thread operation counts; 1 is perfectly fair, 1/threads is one thread only
+        double jain_index = 0;
+        /// Operations of the least served thread, relative to the most served one
+        double min_max_ratio = 0;
+    };
+
+    summary summarize(const run_result & run) {
+        summary result;
+        double sum = 0, sum_of_squares = 0;
+        std::uint64_t least = UINT64_MAX, most = 0;
+        for(const auto & thread : run.per_thread) {
+            const auto operations = thread.reads + thread.writes;
+            result.operations += operations;
+            result.read_latency.merge(thread.read_latency);
+            result.write_latency.merge(thread.write_latency);
+            sum += static_cast<double>(operations);
+            sum_of_squares += static_cast<double>(operations) * static_cast<double>(operations);
+            least = std::min(least, operations);
+            most = std::max(most, operations);
+        }
+        result.latency.merge(result.read_latency);
+        result.latency.merge(result.write_latency);
+        const auto seconds = std::chrono::duration<double>(run.elapsed).count();
+        result.operations_per_second = seconds > 0 ? static_cast<double>(result.operations) / seconds : 0;
+        result.jain_index = sum_of_squares > 0 ? sum * sum / (static_cast<double>(run.per_thread.size()) * sum_of_squares) : 0;
+        result.min_max_ratio = most > 0 ? static_cast<double>(least) / static_cast<double>(most) : 0;
+        return result;
+    }
+
+    std::string json_string(std::string_view value) {
+        std::string escaped = "\"";
+        for(const char c : value) {
+            if(c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+
+    void write_latency_json(std::ostream & out, const latency_histogram & histogram) {
+        out << "{\"samples\": " << histogram.sample_count() << ", \"p50\": " << histogram.percentile(0.5)
+            << ", \"p99\": " << histogram.percentile(0.99) << ", \"p999\": " << histogram.percentile(0.999)
+            << ", \"max\": " << histogram.maximum() << "}";
+    }
+
+    void write_counters_json(std::ostream & out, const lock_metrics::counters & counters) {
+        out << "{\"acquisitions\": " << counters.acquisitions << ", \"contended_acquisitions\": " << counters.contended_acquisitions
+            << ", \"wait_time_ns\": " << counters.wait_time.count() << ", \"max_wait_ns\": " << counters.max_wait.count()
+            << ", \"hold_time_ns\": " << counters.hold_time.count() << "}";
+    }
+
+    void write_json(std::ostream & out, const options & opts, const std::vector<run_result> & runs) {
+        out << "{\n  \"config\": {\"hardware_concurrency\": " << std::thread::hardware_concurrency()
+            << ", \"write_percentage\": " << opts.write_percentage
+            << ", \"distribution\": " << json_string(opts.keys_distribution == distribution::zipf ? "zipf" : "uniform")
+            << ", \"zipf_theta\": " << opts.zipf_theta << ", \"keys\": " << opts.key_count
+            << ", \"duration_ms\": " << opts.duration.count() << ", \"warmup_ms\": " << opts.warmup.count()
+            << ", \"latency_sample_interval\": " << opts.latency_sample_interval << "},\n  \"runs\": [";
+        for(std::size_t i = 0; i < runs.size(); ++i) {
+            const auto & run = runs[i];
+            const auto total = summarize(run);
+            out << (i == 0 ? "\n" : ",\n") << "    {\"backend\": " << json_string(run.backend) << ", \"workload\": " << json_string(run.workload)
+                << ", \"threads\": " << run.threads << ", \"elapsed_ns\": " << run.elapsed.count()
+                << ",\n     \"ops\": " << total.operations << ", \"ops_per_sec\": " << static_cast<std::uint64_t>(total.operations_per_second)
+                << ",\n     \"latency_ns\": ";
+            write_latency_json(out, total.latency);
+            out << ",\n     \"read_latency_ns\": ";
+            write_latency_json(out, total.read_latency);
+            out << ",\n     \"write_latency_ns\": ";
+            write_latency_json(out, total.write_latency);
+            out << ",\n     \"fairness\": {\"jain_index\": " << total.jain_index << ", \"min_max_ratio\": " << total.min_max_ratio << "}";
+            if(run.metrics) {
+                out << ",\n     \"lock_metrics\": {\"shared\": ";
+                write_counters_json(out, run.metrics->shared);
+                out << ", \"exclusive\": ";
+                write_counters_json(out, run.metrics->exclusive);
+                out << "}";
+            }
+            out << ",\n     \"per_thread\": [";
+            for(std::size_t t = 0; t < run.per_thread.size(); ++t) {
+                const auto & thread = run.per_thread[t];
+                latency_histogram latency;
+                latency.merge(thread.read_latency);
+                latency.merge(thread.write_latency);
+                out << (t == 0 ? "" : ", ") << "{\"reads\": " << thread.reads << ", \"writes\": " << thread.writes
+                    << ", \"p99_ns\": " << latency.percentile(0.99) << "}";
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void write_text(std::ostream & out, const run_result & run) {
+        const auto total = summarize(run);
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-40s %4zu %14.0f %9llu %9llu %9llu %7.3f %7.3f\n", run.backend.c_str(), run.threads,
+            total.operations_per_second, static_cast<unsigned long long>(total.latency.percentile(0.5)),
+            static_cast<unsigned long long>(total.latency.percentile(0.99)), static_cast<unsigned long long>(total.latency.percentile(0.999)),
+            total.jain_index, total.min_max_ratio);
+        out << line << std::flush;
+    }
+
+    /*
+     * Command line
+     */
+
+    void print_usage(std::ostream & out) {
+        out << "usage: concurrent_stress [options]\n"
+            "  --backend=NAME[,NAME...]    backends to run, or 'all' (default: std::shared_mutex)\n"
+            "  --threads=N[,N...]          thread counts to run (default: 1,2,4,8)\n"
+            "  --mix=READS:WRITES          operation mix in percent (default: 95:5)\n"
+            "  --distribution=uniform|zipf key distribution (default: uniform)\n"
+            "  --zipf-theta=THETA          skew of the zipf distribution, in (0, 1) (default: 0.99)\n"
+            "  --keys=N                    amount of keys (default: 4096)\n"
+            "  --duration-ms=N             measured duration of each run (default: 1000)\n"
+            "  --warmup-ms=N               unmeasured duration before each run (default: 100)\n"
+            "  --latency-sample=N          time every N-th operation (default: 8)\n"
+            "  --json[=PATH]               write results as JSON to PATH, or to stdout\n"
+            "  --list                      list backends and exit\n"
+            "option values may also be passed as the next argument, eg. --backend all\n";
+    }
+
+    template<typename T>
+    std::vector<T> split(std::string_view value, char separator, T (*convert)(const std::string &)) {
+        std::vector<T> result;
+        while(!value.empty()) {
+            const auto position = value.find(separator);
+            result.push_back(convert(std::string{ value.substr(0, position) }));
+            value = position == std::string_view::npos ? std::string_view{} : value.substr(position + 1);
+        }
+        return result;
+    }
+
+    std::string identity(const std::string & value) { return value; }
+    std::size_t to_size(const std::string & value) { return static_cast<std::size_t>(std::stoull(value)); }
+
+    /**
+     * @brief Parse the command line; std::nullopt if the harness should exit (with `exit_code`).
+     */
+    std::optional<options> parse(int argc, char ** argv, int & exit_code) {
+        options opts;
+        for(int i = 1; i < argc; ++i) {
+            const std::string_view argument{ argv[i] };
+            const auto equals = argument.find('=');
+            const auto name = argument.substr(0, equals);
+            std::string value{ equals == std::string_view::npos ? std::string_view{} : argument.substr(equals + 1) };
+            // Accept `--option value` as well; the value of `--json` is optional, so it only takes one which is not an option.
+            const bool takes_value = name != "--list" && name != "--help" && (name != "--json" || (i + 1 < argc && argv[i + 1][0] != '-'));
+            if(equals == std::string_view::npos && takes_value && i + 1 < argc) {
+                value = argv[++i];
+            }
+            try {
+                if(value.empty() && takes_value && name != "--json") {
+                    throw std::invalid_argument{ "missing value" };
+                }
+                if(name == "--backend") {
+                    opts.backends = split<std::string>(value, ',', identity);
+                } else if(name == "--threads") {
+                    opts.thread_counts = split<std::size_t>(value, ',', to_size);
+                } else if(name == "--mix") {
+                    const auto parts = split<std::size_t>(value, ':', to_size);
+                    if(parts.size() != 2 || parts[0] + parts[1] != 100) {
+                        throw std::invalid_argument{ "percentages must add up to 100" };
+                    }
+                    opts.write_percentage = parts[1];
+                } else if(name == "--distribution" && (value == "uniform" || value == "zipf")) {
+                    opts.keys_distribution = value == "zipf" ? distribution::zipf : distribution::uniform;
+                } else if(name == "--zipf-theta") {
+                    opts.zipf_theta = std::stod(value);
+                    if(!(opts.zipf_theta > 0 && opts.zipf_theta < 1)) {
+                        throw std::invalid_argument{ "theta must be in (0, 1)" };
+                    }
+                } else if(name == "--keys") {
+                    opts.key_count = std::max<std::uint64_t>(to_size(value), 1);
+                } else if(name == "--duration-ms") {
+                    opts.duration = std::chrono::milliseconds{ std::stoll(value) };
+                } else if(name == "--warmup-ms") {
+                    opts.warmup = std::chrono::milliseconds{ std::stoll(value) };
+                } else if(name == "--latency-sample") {
+                    opts.latency_sample_interval = std::max<std::uint64_t>(to_size(value), 1);
+                } else if(name == "--json") {
+                    opts.json_path = value;
+                } else if(name == "--list") {
+                    for(const auto & [backend, _] : backends()) {
+                        std::cout << backend << "\n";
+                    }
+                    exit_code = 0;
+                    return std::nullopt;
+                } else if(name == "--help") {
+                    print_usage(std::cout);
+                    exit_code = 0;
+                    return std::nullopt;
+                } else {
+                    throw std::invalid_argument{ "unknown option" };
+                }
+            } catch(const std::exception & e) {
+                std::cerr << "concurrent_stress: invalid argument '" << argument << "' (" << e.what() << ")\n";
+                print_usage(std::cerr);
+                exit_code = 1;
+                return std::nullopt;
+            }
+        }
+        if(opts.backends.size() == 1 && opts.backends.front() == "all") {
+            opts.backends.clear();
+            for(const auto & [backend, _] : backends()) {
+                opts.backends.push_back(backend);
+            }
+        }
+        return opts;
+    }
+}
+
+int main(int argc, char ** argv) {
+    register_backends();
+    int exit_code = 0;
+    const auto opts = parse(argc, argv, exit_code);
+    if(!opts) {
+        return exit_code;
+    }
+    std::vector<runner> selected;
+    for(const auto & name : opts->backends) {
+        const auto it = std::find_if(backends().begin(), backends().end(), [&](const auto & entry) { return entry.first == name; });
+        if(it == backends().end()) {
+            std::cerr << "concurrent_stress: unknown backend '" << name << "' (see --list)\n";
+            return 1;
+        }
+        selected.push_back(it->second);
+    }
+
+    // Text goes to stderr when JSON goes to stdout.
+    auto & text = opts->json_path && opts->json_path->empty() ? std::cerr : std::cout;
+    char header[256];
+    std::snprintf(header, sizeof(header), "%-40s %4s %14s %9s %9s %9s %7s %7s\n", "backend", "thr", "ops/s", "p50(ns)", "p99(ns)",
+        "p999(ns)", "jain", "min/max");
+    text << header;
+    std::vector<run_result> runs;
+    for(std::size_t i = 0; i < selected.size(); ++i) {
+        for(const auto threads : opts->thread_counts) {
+            runs.push_back(selected[i](opts->backends[i], *opts, std::max<std::size_t>(threads, 1)));
+            write_text(text, runs.back());
+        }
+    }
+
+    if(opts->json_path) {
+        if(opts->json_path->empty()) {
+            write_json(std::cout, *opts, runs);
+        } else {
+            std::ostringstream json;
+            write_json(json, *opts, runs);
+            std::unique_ptr<std::FILE, int (*)(std::FILE *)> file{ std::fopen(opts->json_path->c_str(), "w"), &std::fclose };
+            if(!file || std::fputs(json.str().c_str(), file.get()) < 0) {
+                std::cerr << "concurrent_stress: can not write '" << *opts->json_path << "'\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
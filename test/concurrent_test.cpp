@@ -0,0 +1,384 @@
+/**
+ * ______________________________________________________
+ * Regression tests of the concurrent wrapper and its lock backends (run by ctest).
+ *
+ * Every test runs in turn, or only those named on the command line, eg.
+ *
+ * concurrent_test lock_all_rank_order
+ *
+ * @file 	concurrent_test.cpp
+ * @author 	Mustafa Kemal GILOR <mustafagilor@gmail.com>
+ * @date 	02.12.2020
+ *
+ * SPDX-License-Identifier:	MIT
+ * ______________________________________________________
+ */
+
+// Lock order checks are what the lock_all tests verify, so keep them in release builds as well.
+#define MKG_CONCURRENT_LOCK_ORDER_CHECKS 1
+
+#include <algorithm>    // std::find_if
+#include <atomic>       // std::atomic
+#include <cstdint>      // std::uint64_t
+#include <cstdio>       // std::fprintf
+#include <mutex>        // std::unique_lock
+#include <shared_mutex> // std::shared_mutex
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <thread>       // std::thread
+#include <utility>      // std::pair
+#include <vector>       // std::vector
+
+#include "concurrent_stl.hpp"
+#include "concurrent_queue.hpp"
+#include "lockable_async.hpp"
+#include "lockable_compact.hpp"
+#include "lockable_elision.hpp"
+#include "lockable_ranked.hpp"
+
+using namespace mkg;
+
+namespace {
+
+    /*
+     * Test registry: a test is a function which reports failed expectations through `expect`.
+     */
+
+    using test_function = void (*)();
+
+    std::vector<std::pair<std::string_view, test_function>> & tests() {
+        static std::vector<std::pair<std::string_view, test_function>> registry;
+        return registry;
+    }
+
+    std::size_t failures = 0;
+
+    void expect(bool condition, const char * expression, const std::source_location & site = std::source_location::current()) {
+        if(!condition) {
+            ++failures;
+            std::fprintf(stderr, "%s:%u: expectation failed: %s\n", site.file_name(), static_cast<unsigned>(site.line()), expression);
+        }
+    }
+
+#define EXPECT(...) expect(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__)
+
+    /*
+     * lock_all
+     */
+
+    std::vector<lock_order_violation> violations;
+
+    void record_violation(const lock_order_violation & violation) { violations.push_back(violation); }
+
+    /**
+     * Runs `fn` with lock order violations recorded (instead of aborting), and returns them.
+     */
+    template<typename Fn>
+    std::vector<lock_order_violation> recording_violations(Fn && fn) {
+        violations.clear();
+        const auto previous = set_lock_order_handler(&record_violation);
+        fn();
+        set_lock_order_handler(previous);
+        return std::exchange(violations, {});
+    }
+
+    void lock_all_rank_order() {
+        // Declared so the lower ranked lock gets either address, relative to the higher ranked one.
+        struct resources {
+            concurrent<int, ranked<std::shared_mutex, 2>> before{ 0 };
+            concurrent<int, ranked<std::shared_mutex, 1>> low{ 0 };
+            concurrent<int, ranked<std::shared_mutex, 2>> high{ 0 };
+        } r;
+        const auto reported = recording_violations([&] {
+            { auto accessors = lock_all(exclusive_access(r.low), exclusive_access(r.high)); }
+            { auto accessors = lock_all(exclusive_access(r.high), exclusive_access(r.low)); }
+            { auto accessors = lock_all(exclusive_access(r.before), shared_access(r.low)); }
+            static_cast<void>(apply([](int & high, const int & low) { return high + low; }, exclusive_access(r.high), shared_access(r.low)));
+        });
+        EXPECT(reported.empty());
+    }
+
+    void lock_all_reports_call_sites() {
+        concurrent<int, ranked<std::shared_mutex, 1>> low{ 0 };
+        concurrent<int, ranked<std::shared_mutex, 2>> high{ 0 };
+        std::uint_least32_t held_line = 0, acquired_line = 0;
+        const auto reported = recording_violations([&] {
+            held_line = std::source_location::current().line() + 1;
+            auto held = lock_all(exclusive_access(high));
+            acquired_line = std::source_location::current().line() + 1;
+            auto inverted = lock_all(exclusive_access(low));
+        });
+        EXPECT(reported.size() == 1);
+        if(reported.size() == 1) {
+            EXPECT(reported.front().kind == lock_order_violation::violation_kind::rank_inversion);
+            EXPECT(reported.front().held_site.line() == held_line);
+            EXPECT(reported.front().acquired_site.line() == acquired_line);
+            EXPECT(std::string_view{ reported.front().acquired_site.file_name() }.ends_with("concurrent_test.cpp"));
+        }
+    }
+
+    /**
+     * @brief Run `fn(thread_index)` on `thread_count` threads at once, and wait for all of them.
+     */
+    template<typename Fn>
+    void run_threads(std::size_t thread_count, Fn fn) {
+        std::vector<std::thread> threads;
+        for(std::size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back(fn, i);
+        }
+        for(auto & thread : threads) {
+            thread.join();
+        }
+    }
+
+    constexpr std::size_t thread_count = 4;
+
+    /*
+     * Storage specializations
+     */
+
+    struct range {
+        int low;
+        int high;
+    };
+
+    /**
+     * A shared lock which counts its acquisitions.
+     */
+    struct counting_shared_mutex {
+        void lock() { ++exclusive; underlying.lock(); }
+        void unlock() { underlying.unlock(); }
+        void lock_shared() { ++shared; underlying.lock_shared(); }
+        void unlock_shared() { underlying.unlock_shared(); }
+
+        std::shared_mutex underlying;
+        std::atomic<std::size_t> exclusive = {0};
+        std::atomic<std::size_t> shared = {0};
+    };
+
+    template<typename ConcurrentType>
+    concept seqlock_backed = requires (const ConcurrentType & resource) { resource.snapshot(); resource.version(); };
+
+    template<typename ConcurrentType>
+    concept atomic_backed = requires (ConcurrentType & resource) { resource.fetch_add(1); resource.load(); };
+
+    void storage_selection() {
+        // Trivially copyable and lock-free sized types keep the lock they are given, unless tagged.
+        static_assert(!seqlock_backed<concurrent<range>> && !atomic_backed<concurrent<range>>);
+        static_assert(!seqlock_backed<concurrent<range, counting_shared_mutex>>);
+        static_assert(!atomic_backed<concurrent<std::uint64_t>> && !seqlock_backed<concurrent<std::uint64_t>>);
+        static_assert(seqlock_backed<concurrent<seqlocked<range>>>);
+        static_assert(atomic_backed<concurrent<lock_free<std::uint64_t>>>);
+
+        concurrent<range, counting_shared_mutex> bounds{ range{ 1, 2 } };
+        EXPECT(bounds.read([](const range & current) { return current.high; }) == 2);
+        bounds.write([](range & current) { current.high = 3; });
+        EXPECT(bounds.read_access_handle()->high == 3);
+        const auto & lockable = detail::concurrent_access::lockable(bounds);
+        EXPECT(lockable.shared == 2 && lockable.exclusive == 1);
+
+        concurrent<seqlocked<range>> tagged{ range{ 1, 2 } };
+        tagged.write([](range & current) { current.low = 0; });
+        EXPECT(tagged.snapshot().low == 0 && tagged.version() % 2 == 0);
+    }
+
+    /**
+     * A trivially copyable resource, which `read_cache` must accept behind a `versioned` lock and a seqlock alike.
+     */
+    struct pod_config {
+        int timeout_ms;
+        int retries;
+        double ratio;
+    };
+
+    void read_cache_of_pod() {
+        static_assert(std::is_constructible_v<read_cache<concurrent<pod_config, versioned<std::shared_mutex>>>,
+            const concurrent<pod_config, versioned<std::shared_mutex>> &>);
+        static_assert(std::is_constructible_v<read_cache<concurrent<seqlocked<pod_config>>>, const concurrent<seqlocked<pod_config>> &>);
+
+        concurrent<seqlocked<pod_config>> config{ pod_config{ 100, 3, 0.5 } };
+        read_cache<concurrent<seqlocked<pod_config>>> cache{ config };
+        EXPECT(cache.cached_read().retries == 3);
+        config.write([](pod_config & current) { current.retries = 5; });
+        EXPECT(cache.cached_read().retries == 5);
+    }
+
+    /*
+     * compact_shared_mutex
+     */
+
+    struct small_resource {
+        std::uint16_t id;
+        std::uint8_t flags[4];
+    };
+
+    struct word_resource {
+        std::uint32_t id;
+        float weight;
+    };
+
+    void compact_layout() {
+        static_assert(sizeof(concurrent<small_resource, compact_shared_mutex>) == sizeof(small_resource) + 2,
+            "concurrent<T, compact_shared_mutex> must take sizeof(T) + 2 bytes.");
+        static_assert(sizeof(concurrent<word_resource, compact_shared_mutex>) <= sizeof(word_resource) + alignof(word_resource),
+            "concurrent<T, compact_shared_mutex> must take sizeof(T) + 2 bytes, rounded up to the alignment of T.");
+
+        concurrent<small_resource, compact_shared_mutex> resource{ small_resource{ 7, { 1, 2, 3, 4 } } };
+        run_threads(thread_count, [&](std::size_t) {
+            for(int i = 0; i < 10000; ++i) {
+                resource.write([](small_resource & current) { ++current.id; });
+                static_cast<void>(resource.read([](const small_resource & current) { return current.flags[0]; }));
+            }
+        });
+        EXPECT(resource.read_access_handle()->id == 7 + thread_count * 10000);
+    }
+
+    /*
+     * elided
+     */
+
+    void elided_out_of_order_release() {
+        constexpr long per_thread = 20000;
+        elided<std::shared_mutex> first, second;
+        long first_count = 0, second_count = 0;
+        run_threads(thread_count, [&](std::size_t index) {
+            for(long i = 0; i < per_thread; ++i) {
+                // Released in acquisition (not reverse) order; each release must take the path of its own acquisition.
+                std::unique_lock<elided<std::shared_mutex>> outer{ index % 2 == 0 ? first : second };
+                std::unique_lock<elided<std::shared_mutex>> inner{ index % 2 == 0 ? second : first, std::defer_lock };
+                if(!inner.try_lock()) {
+                    continue;
+                }
+                ++first_count;
+                ++second_count;
+                outer.unlock();
+                inner.unlock();
+            }
+        });
+        EXPECT(first_count == second_count);
+        EXPECT(first.try_lock() && second.try_lock());
+        first.unlock();
+        second.unlock();
+    }
+
+    void lock_free_writes_are_not_lost() {
+        constexpr std::uint64_t per_thread = 20000;
+        concurrent<lock_free<std::uint64_t>> counter;
+        concurrent<lock_free<float>> total{ 0.0f };
+        run_threads(thread_count, [&](std::size_t) {
+            for(std::uint64_t i = 0; i < per_thread; ++i) {
+                counter.write([](std::uint64_t & value) { value += 2; });
+                counter.fetch_sub(1);
+                total.write([](float & value) { value += 1.0f; });
+            }
+        });
+        EXPECT(counter.load() == thread_count * per_thread);
+        // Every count stays exactly representable as a float.
+        EXPECT(total.load() == static_cast<float>(thread_count * per_thread));
+    }
+
+    /*
+     * async_shared_mutex
+     */
+
+    void async_blocking_waiters() {
+        constexpr long per_thread = 20000;
+        // Waiters are blocked threads whose wait state lives on their stack; it is destroyed as soon as the lock is granted.
+        concurrent<long, async_shared_mutex> resource{ 0 };
+        run_threads(thread_count, [&](std::size_t index) {
+            for(long i = 0; i < per_thread; ++i) {
+                if(index % 2 == 0 || i % 4 == 0) {
+                    ++*resource.write_access_handle();
+                } else {
+                    static_cast<void>(*resource.read_access_handle());
+                }
+            }
+        });
+        EXPECT(*resource.read_access_handle() == (thread_count / 2) * per_thread + (thread_count / 2) * (per_thread / 4));
+    }
+
+    /*
+     * concurrent_queue
+     */
+
+    std::atomic<long> live_elements = {0};
+
+    /**
+     * An element which counts its live instances, so leaked or doubly destroyed elements show up.
+     */
+    struct tracked {
+        explicit tracked(std::uint64_t value) noexcept : value{ value } { ++live_elements; }
+        tracked(tracked && other) noexcept : value{ other.value } { ++live_elements; }
+        ~tracked() { --live_elements; }
+        std::uint64_t value;
+    };
+
+    void queue_pops_across_segments() {
+        {
+            concurrent_queue<tracked, 4> queue;
+            for(std::uint64_t i = 0; i < 64; ++i) {
+                queue.emplace(i);
+            }
+            // Every fourth pop retires a segment, and moves on to the next one.
+            bool in_order = true;
+            for(std::uint64_t i = 0; i < 60; ++i) {
+                const auto element = queue.try_pop();
+                in_order = in_order && element && element->value == i;
+            }
+            EXPECT(in_order);
+            EXPECT(live_elements == 4);
+        }
+        EXPECT(live_elements == 0);
+    }
+
+    void queue_reclaims_segments_concurrently() {
+        constexpr std::uint64_t per_thread = 50000;
+        std::atomic<std::uint64_t> popped = {0}, sum = {0};
+        {
+            concurrent_queue<tracked, 8> queue;
+            run_threads(thread_count, [&](std::size_t index) {
+                if(index % 2 == 0) {
+                    for(std::uint64_t i = 0; i < per_thread; ++i) {
+                        queue.emplace(i);
+                    }
+                    return;
+                }
+                while(popped.load() < (thread_count / 2) * per_thread) {
+                    if(const auto element = queue.try_pop()) {
+                        sum += element->value;
+                        ++popped;
+                    }
+                }
+            });
+            EXPECT(!queue.try_pop());
+        }
+        EXPECT(sum == (thread_count / 2) * (per_thread * (per_thread - 1) / 2));
+        EXPECT(live_elements == 0);
+    }
+
+    void register_tests() {
+        tests().emplace_back("lock_all_rank_order", &lock_all_rank_order);
+        tests().emplace_back("lock_all_reports_call_sites", &lock_all_reports_call_sites);
+        tests().emplace_back("storage_selection", &storage_selection);
+        tests().emplace_back("read_cache_of_pod", &read_cache_of_pod);
+        tests().emplace_back("compact_layout", &compact_layout);
+        tests().emplace_back("elided_out_of_order_release", &elided_out_of_order_release);
+        tests().emplace_back("lock_free_writes_are_not_lost", &lock_free_writes_are_not_lost);
+        tests().emplace_back("async_blocking_waiters", &async_blocking_waiters);
+        tests().emplace_back("queue_pops_across_segments", &queue_pops_across_segments);
+        tests().emplace_back("queue_reclaims_segments_concurrently", &queue_reclaims_segments_concurrently);
+    }
+}
+
+int main(int argc, char ** argv) {
+    register_tests();
+    for(const auto & [name, test] : tests()) {
+        const bool selected = argc < 2 || std::find_if(argv + 1, argv + argc, [&](const char * argument) { return name == argument; }) != argv + argc;
+        if(selected) {
+            const auto failed_before = failures;
+            test();
+            std::fprintf(stderr, "%-40s %s\n", std::string(name).c_str(), failures == failed_before ? "ok" : "FAILED");
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}